@@ -54,7 +54,8 @@ endfunction(piglit_include_target_api)
 # This function wraps `add_executable` and has the same signature.
 #
 # In addition to calling `add_executable`, it adds to each object file
-# a dependency on piglit_dispatch's generated files.
+# a dependency on piglit_dispatch's generated files. With
+# PIGLIT_BUILD_TEST_MODULES, the test is also built as lib/modules/<name>.so.
 #
 function(piglit_add_executable name)
 
@@ -66,6 +67,25 @@ function(piglit_add_executable name)
 
     install(TARGETS ${name} DESTINATION ${PIGLIT_INSTALL_LIBDIR}/bin)
 
+    # The same test as a module that piglit-zygote loads into a forked
+    # process, instead of executing the binary.
+    if(PIGLIT_BUILD_TEST_MODULES)
+        add_library(${name}_module MODULE ${ARGV})
+        # Custom commands generating sources, like the bin2h.py headers,
+        # are attached to both targets. Build the module after the
+        # executable, so each command runs once and is finished before
+        # the module is compiled.
+        add_dependencies(${name}_module ${name})
+        target_include_directories(${name}_module PRIVATE
+            ${CMAKE_CURRENT_BINARY_DIR})
+        set_target_properties(${name}_module PROPERTIES
+            OUTPUT_NAME ${name}
+            PREFIX ""
+            LIBRARY_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/lib/modules)
+        install(TARGETS ${name}_module
+                DESTINATION ${PIGLIT_INSTALL_LIBDIR}/lib/modules)
+    endif()
+
 endfunction(piglit_add_executable)
 
 #
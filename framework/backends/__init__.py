@@ -46,7 +46,7 @@ import os
 import importlib
 
 from .register import Registry
-from .compression import COMPRESSION_SUFFIXES
+from .compression import COMPRESSION_SUFFIXES, get_mode_of_suffix
 
 __all__ = [
     'BACKENDS',
@@ -128,7 +128,7 @@ def get_extension(file_path):
         # with.
         # i.e: Use .json.gz rather that .gz
         if extension in COMPRESSION_SUFFIXES:
-            compression = extension[1:]  # Drop the leading '.'
+            compression = get_mode_of_suffix(extension)
             # Remove any trailing '.', this fixes a bug where the filename
             # is 'foo.json..xz, or similar
             extension = os.path.splitext(name.rstrip('.'))[1]
@@ -29,6 +29,7 @@ This module provides mixins and base classes for backend modules.
 import abc
 import contextlib
 import itertools
+import multiprocessing
 import os
 import shutil
 
@@ -53,9 +54,8 @@ def write_compressed(filename):
         # if the suffix (final .xxx) is a knwon compression suffix
         suffix = os.path.splitext(filename)[1]
         if suffix in compression.COMPRESSION_SUFFIXES:
-            filename = '{}.{}'.format(os.path.splitext(filename)[0], mode)
-        else:
-            filename = '{}.{}'.format(filename, mode)
+            filename = os.path.splitext(filename)[0]
+        filename += compression.get_suffix(mode)
 
     with compression.COMPRESSORS[mode](filename) as f:
         yield f
@@ -144,6 +144,30 @@ class Backend(metaclass=abc.ABCMeta):
 
         """
 
+    def share_with_processes(self):
+        """ Prepare for tests to be written from forked processes
+
+        Called before the backend is inherited by worker processes, which
+        write tests with write_test() at the same time as each other. Backends
+        that keep state between tests must make it safe to share.
+
+        """
+
+
+class _SharedCounter(object):
+    """An itertools.count() that can be shared with forked processes."""
+    def __init__(self, start):
+        self._value = multiprocessing.Value('q', start)
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        with self._value.get_lock():
+            value = self._value.value
+            self._value.value += 1
+        return value
+
 
 class FileBackend(Backend):
     """ A baseclass for file based backends
@@ -169,6 +193,10 @@ class FileBackend(Backend):
 
     __INCOMPLETE = TestResult(result=INCOMPLETE)
 
+    def share_with_processes(self):
+        # The test files are numbered, the numbers must stay unique.
+        self._counter = _SharedCounter(next(self._counter))
+
     def __fsync(self, file_):
         """ Sync the file to disk
 
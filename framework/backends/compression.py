@@ -24,9 +24,10 @@
 This includes both compression and decompression support.
 
 This provides a low level interface of dictionaries, COMPRESSORS and
-DECOMPRESSORS, which use compression modes ('bz2', 'gz', 'xz', 'none') to
-provide open-like functions with correct mode settings for writing or reading,
-respectively.
+DECOMPRESSORS, which use compression modes ('bz2', 'gz', 'xz', 'zstd', 'none')
+to provide open-like functions with correct mode settings for writing or
+reading, respectively. zstd requires the zstandard python module. The file
+suffix of each mode is in SUFFIXES, get_suffix() returns it.
 
 They should always take unicode (str in python 3.x) objects. It is up to the
 caller to ensure that they're passing unicode and not bytes.
@@ -36,9 +37,16 @@ the PIGLIT_COMPRESSION environment variable, then the piglit.conf
 [core]:compression key, and finally the value of compression.DEFAULT). This is
 the best way to get a compressor.
 
+The compressors split the output into blocks that are compressed by a pool of
+threads (get_threads() returns the number), and write each block as a separate
+stream. The standard tools and the decompressors read the concatenated streams
+as a single file. get_level() returns the compression level, if one was set.
+
 """
 
 import bz2
+import collections
+import concurrent.futures
 import contextlib
 import errno
 import functools
@@ -51,11 +59,27 @@ import subprocess
 from framework import core
 from framework import exceptions
 
+try:
+    import zstandard
+    _ZSTD = True
+except ImportError:
+    _ZSTD = False
+
+# Modes that need an optional module, and how to get it
+_INSTALL_HINTS = {
+    'zstd': 'install the zstandard python module, version 0.18 or later',
+}
+
 __all__ = [
     'UnsupportedCompressor',
     'COMPRESSORS',
     'DECOMPRESSORS',
+    'get_decompressor',
+    'get_level',
     'get_mode',
+    'get_mode_of_suffix',
+    'get_suffix',
+    'get_threads',
 ]
 
 
@@ -65,28 +89,174 @@ class UnsupportedCompressor(exceptions.PiglitInternalError):
         self.__method = method
 
     def __str__(self):
+        if self.__method in _INSTALL_HINTS:
+            return 'unsupported compression method {}, {}'.format(
+                self.__method, _INSTALL_HINTS[self.__method])
         return 'unsupported compression method {}'.format(self.__method)
 
 
+# The size of the blocks that are compressed independently. This is a multiple
+# of the block size of bz2 and of the dictionary of the default xz preset, so
+# the ratio is close to compressing the file as a whole.
+BLOCK_SIZE = 8 * 1024 * 1024
+
+
+class _BlockWriter(io.BufferedIOBase):
+    """A binary file that compresses blocks in a pool of threads.
+
+    All of the compression modules release the GIL while compressing, so the
+    blocks are compressed in parallel. At most two blocks per thread are kept
+    in memory, the compressed blocks are written in order.
+
+    Arguments:
+    compress -- a function that compresses a block of bytes into a stream
+    filename -- the file to write to
+    threads -- the number of threads to compress with
+
+    """
+    def __init__(self, compress, filename, threads):
+        super(_BlockWriter, self).__init__()
+        self._compress = compress
+        self._file = open(filename, 'wb')
+        self._threads = threads
+        self._buffer = bytearray()
+        self._pending = collections.deque()
+        self._executor = None
+        if threads > 1:
+            self._executor = concurrent.futures.ThreadPoolExecutor(threads)
+
+    def writable(self):
+        return True
+
+    def write(self, b):
+        self._buffer += b
+        while len(self._buffer) >= BLOCK_SIZE:
+            self._submit(bytes(self._buffer[:BLOCK_SIZE]))
+            del self._buffer[:BLOCK_SIZE]
+        return len(b)
+
+    def _submit(self, block):
+        if self._executor is None:
+            self._file.write(self._compress(block))
+            return
+        self._pending.append(self._executor.submit(self._compress, block))
+        while len(self._pending) > 2 * self._threads:
+            self._file.write(self._pending.popleft().result())
+
+    def close(self):
+        if self.closed:
+            return
+        try:
+            # An empty file is still a valid compressed file
+            if self._buffer or not self._file.tell() and not self._pending:
+                self._submit(bytes(self._buffer))
+            while self._pending:
+                self._file.write(self._pending.popleft().result())
+        finally:
+            if self._executor is not None:
+                self._executor.shutdown()
+            self._file.close()
+            super(_BlockWriter, self).close()
+
+
+def _open_blocks(mode, compress, level_arg, filename):
+    """Open a text file that is compressed in parallel blocks.
+
+    If a level is set it is passed to compress as the keyword argument
+    level_arg.
+
+    """
+    level = get_level(mode)
+    if level is not None:
+        compress = functools.partial(compress, **{level_arg: level})
+    return io.TextIOWrapper(_BlockWriter(compress, filename, get_threads()),
+                            encoding='utf-8')
+
+
+def _compress_zstd(block, level=3):
+    return zstandard.ZstdCompressor(level=level).compress(block)
+
+
+class _ZstdTextFile(io.TextIOWrapper):
+    """A TextIOWrapper with a name, the zstd reader doesn't have one."""
+    def __init__(self, buffer, name):
+        super(_ZstdTextFile, self).__init__(buffer, encoding='utf-8')
+        self.__name = name
+
+    @property
+    def name(self):
+        return self.__name
+
+
+def _open_zstd(filename):
+    """Open a text file compressed with zstd, which may be several frames."""
+    reader = zstandard.ZstdDecompressor().stream_reader(
+        open(filename, 'rb'), read_across_frames=True, closefd=True)
+    return _ZstdTextFile(reader, filename)
+
+
+def _zstd_usable():
+    """Check that the zstandard module can read several frames.
+
+    Older versions of the module lack the arguments _open_zstd() needs, or
+    raise when reading across frames.
+
+    """
+    data = _compress_zstd(b'a') + _compress_zstd(b'b')
+    try:
+        reader = zstandard.ZstdDecompressor().stream_reader(
+            io.BytesIO(data), read_across_frames=True, closefd=True)
+        read = b''
+        while True:
+            chunk = reader.read(1024)
+            if not chunk:
+                return read == b'ab'
+            read += chunk
+    except (TypeError, NotImplementedError, zstandard.ZstdError):
+        return False
+
 
 DEFAULT = 'bz2'
 
-COMPRESSION_SUFFIXES = ['.gz', '.bz2', '.xz']
+# The suffix of the files of each mode
+SUFFIXES = {
+    'bz2': '.bz2',
+    'gz': '.gz',
+    'xz': '.xz',
+    'zstd': '.zst',
+}
+
+COMPRESSION_SUFFIXES = sorted(SUFFIXES.values())
+
+# The valid compression levels of each mode
+LEVELS = {
+    'bz2': range(1, 10),
+    'gz': range(0, 10),
+    'xz': range(0, 10),
+    'zstd': range(1, 23),
+}
 
 COMPRESSORS = {
-    'bz2': functools.partial(bz2.open, mode='wt'),
-    'gz': functools.partial(gzip.open, mode='wt'),
+    'bz2': functools.partial(_open_blocks, 'bz2', bz2.compress,
+                             'compresslevel'),
+    'gz': functools.partial(_open_blocks, 'gz', gzip.compress,
+                            'compresslevel'),
     'none': functools.partial(open, mode='w'),
-    'xz': functools.partial(lzma.open, mode='wt'),
+    'xz': functools.partial(_open_blocks, 'xz', lzma.compress, 'preset'),
 }
 
 DECOMPRESSORS = {
-    'bz2': functools.partial(bz2.open, mode='rt'),
-    'gz': functools.partial(gzip.open, mode='rt'),
+    'bz2': functools.partial(bz2.open, mode='rt', encoding='utf-8'),
+    'gz': functools.partial(gzip.open, mode='rt', encoding='utf-8'),
     'none': functools.partial(open, mode='r'),
-    'xz': functools.partial(lzma.open, mode='rt'),
+    'xz': functools.partial(lzma.open, mode='rt', encoding='utf-8'),
 }
 
+if _ZSTD and _zstd_usable():
+    COMPRESSORS['zstd'] = functools.partial(_open_blocks, 'zstd',
+                                            _compress_zstd, 'level')
+    DECOMPRESSORS['zstd'] = _open_zstd
+
 
 def get_mode():
     """Return the key value of the correct compressor to use.
@@ -111,3 +281,74 @@ def get_mode():
         raise UnsupportedCompressor(method)
 
     return method
+
+
+def get_suffix(mode):
+    """Return the file suffix of a mode, '' for 'none'."""
+    return SUFFIXES.get(mode, '')
+
+
+def get_decompressor(mode):
+    """Return the decompressor of a mode.
+
+    Raises UnsupportedCompressor if the mode is not supported, for example
+    because the module it needs is not installed.
+
+    """
+    try:
+        return DECOMPRESSORS[mode]
+    except KeyError:
+        raise UnsupportedCompressor(mode)
+
+
+def get_mode_of_suffix(suffix):
+    """Return the mode of a file suffix, or None if it isn't compressed."""
+    for mode, suffix_ in SUFFIXES.items():
+        if suffix == suffix_:
+            return mode
+    return None
+
+
+def get_threads():
+    """Return the number of threads to compress with.
+
+    Try the environment variable PIGLIT_COMPRESSION_THREADS; then check the
+    PIGLIT_CONFIG section 'core', option 'compression_threads'; finally fall
+    back to the number of CPUs.
+
+    """
+    threads = core.get_option('PIGLIT_COMPRESSION_THREADS',
+                              ('core', 'compression_threads'))
+    if threads is None:
+        return os.cpu_count() or 1
+
+    try:
+        return max(int(threads), 1)
+    except ValueError:
+        raise exceptions.PiglitFatalError(
+            'compression_threads must be an integer, not "{}"'.format(
+                threads))
+
+
+def get_level(mode):
+    """Return the compression level to use for a mode, or None.
+
+    Try the environment variable PIGLIT_COMPRESSION_LEVEL; then check the
+    PIGLIT_CONFIG section 'core', option 'compression_level'. If neither is
+    set return None, each mode then uses its own default level.
+
+    """
+    level = core.get_option('PIGLIT_COMPRESSION_LEVEL',
+                            ('core', 'compression_level'))
+    if level is None:
+        return None
+
+    try:
+        level = int(level)
+    except ValueError:
+        level = None
+    if level not in LEVELS[mode]:
+        raise exceptions.PiglitFatalError(
+            'compression_level for {} must be an integer from {} to {}'.format(
+                mode, LEVELS[mode][0], LEVELS[mode][-1]))
+    return level
@@ -0,0 +1,199 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Append-only journal of test results.
+
+A journal is a single file that the results of a run are appended to while
+the run is in progress. Every record starts with a header holding the length
+of its payload and the CRC-32 of the payload, a record that was torn by a
+crash or corrupted on the disk ends the journal and anything after it is
+ignored.
+
+The payload is a kind byte, the name of the test, a newline and the data of
+the test. A test gets a STARTED record before it runs and a FINISHED record
+with its result when it is done, the latest record of a name wins.
+
+Records are appended with a single write() to a file opened with O_APPEND,
+so threads and forked processes can share one writer.
+"""
+
+import collections
+import errno
+import os
+import struct
+import threading
+import zlib
+
+__all__ = [
+    'FINISHED',
+    'STARTED',
+    'Reader',
+    'Writer',
+]
+
+STARTED = b'S'
+FINISHED = b'F'
+
+# The length and CRC-32 of the payload
+_HEADER = struct.Struct('>II')
+
+
+def _scan(f):
+    """Yield (offset, payload) for each valid record of an open file."""
+    offset = f.tell()
+    while True:
+        header = f.read(_HEADER.size)
+        if len(header) < _HEADER.size:
+            return
+        length, crc = _HEADER.unpack(header)
+        payload = f.read(length)
+        if len(payload) < length or zlib.crc32(payload) != crc:
+            return
+        yield offset, payload
+        offset += _HEADER.size + length
+
+
+def _split(payload):
+    """Split a payload into kind, name and data."""
+    name, data = payload[1:].split(b'\n', 1)
+    return payload[:1], name.decode('utf-8'), data.decode('utf-8')
+
+
+class Writer(object):
+    """Append records to a journal.
+
+    The journal is opened on the first append. If it already exists any torn
+    record at its end is cut off first, otherwise the records appended after
+    it could never be read.
+
+    Arguments:
+    filename -- the path of the journal
+
+    """
+    def __init__(self, filename):
+        self._filename = filename
+        self._fd = None
+        self._torn = False
+        self._lock = threading.Lock()
+
+    def open(self):
+        """Open the journal if it isn't already.
+
+        This must be called before the writer is shared with forked
+        processes, so that only one of them repairs the journal.
+
+        """
+        with self._lock:
+            if self._fd is not None:
+                return
+            fd = os.open(self._filename,
+                         os.O_WRONLY | os.O_APPEND | os.O_CREAT, 0o644)
+            with open(self._filename, 'rb') as f:
+                end = 0
+                for offset, payload in _scan(f):
+                    end = offset + _HEADER.size + len(payload)
+            if end != os.fstat(fd).st_size:
+                os.ftruncate(fd, end)
+            self._fd = fd
+
+    def append(self, kind, name, data, sync=False):
+        """Append a record.
+
+        Arguments:
+        kind -- STARTED or FINISHED
+        name -- the name of the test
+        data -- the data of the test, a str
+
+        Keyword Arguments:
+        sync -- if True the journal is synced to the disk after the write
+
+        Raises OSError if the record was not written completely. The records
+        after a torn record cannot be read, so every later append raises as
+        well.
+
+        """
+        self.open()
+        if self._torn:
+            raise OSError(errno.EIO, 'The journal {} has a torn record'.format(
+                self._filename))
+        payload = b''.join(
+            [kind, name.encode('utf-8'), b'\n', data.encode('utf-8')])
+        record = _HEADER.pack(len(payload), zlib.crc32(payload)) + payload
+        written = os.write(self._fd, record)
+        if written != len(record):
+            self._torn = True
+            raise OSError(errno.ENOSPC,
+                          'Short write to the journal {}: {} of {} bytes'.format(
+                              self._filename, written, len(record)))
+        if sync:
+            os.fsync(self._fd)
+
+    def close(self):
+        with self._lock:
+            if self._fd is not None:
+                os.close(self._fd)
+                self._fd = None
+
+
+class Reader(object):
+    """Read the tests of a journal.
+
+    Arguments:
+    filename -- the path of the journal
+
+    """
+    def __init__(self, filename):
+        self._filename = filename
+
+    def __iter__(self):
+        """Yield (kind, name, data) for every record, in the order written."""
+        with open(self._filename, 'rb') as f:
+            for _, payload in _scan(f):
+                yield _split(payload)
+
+    def latest(self):
+        """Return an OrderedDict of the name and the offset of the latest
+        record of every test, in the order the tests were first written.
+        """
+        offsets = collections.OrderedDict()
+        with open(self._filename, 'rb') as f:
+            for offset, payload in _scan(f):
+                offsets[_split(payload)[1]] = offset
+        return offsets
+
+    def tests(self, offsets=None):
+        """Yield (name, data) for the latest record of every test.
+
+        The journal is read twice, once to find the latest records and once
+        to read them, so only the offsets are kept in memory.
+
+        Keyword Arguments:
+        offsets -- the return value of latest(), if it was already called
+
+        """
+        if offsets is None:
+            offsets = self.latest()
+        with open(self._filename, 'rb') as f:
+            for name, offset in offsets.items():
+                f.seek(offset)
+                _, payload = next(_scan(f))
+                yield name, _split(payload)[2]
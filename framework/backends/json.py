@@ -22,7 +22,9 @@
 """ Module providing json backend for piglit """
 
 import collections
-import functools
+import contextlib
+import itertools
+import multiprocessing
 import os
 import shutil
 import sys
@@ -32,16 +34,10 @@ try:
 except ImportError:
     import json
 
-try:
-    import jsonstreams
-    _STREAMS = True
-except ImportError:
-    _STREAMS = False
-
-from framework import status, results, exceptions
+from framework import status, results, exceptions, options
 from .abstract import FileBackend, write_compressed
 from .register import Registry
-from . import compression
+from . import compression, journal
 
 __all__ = [
     'REGISTRY',
@@ -57,6 +53,15 @@ MINIMUM_SUPPORTED_VERSION = 7
 # The level to indent a final file
 INDENT = 4
 
+# The journal the tests are written to while a run is in progress
+JOURNAL = 'results.journal'
+
+# Runs with at least this many tests are encoded by a pool of processes
+_PARALLEL_TESTS = 4096
+
+# The number of tests a process encodes at once
+_CHUNK_SIZE = 256
+
 
 def piglit_encoder(obj):
     """ Encoder for piglit that can transform additional classes into json
@@ -80,14 +85,25 @@ class JSONBackend(FileBackend):
     json module or the simplejson.
 
     This class is atomic, writes either completely fail or completely succeed.
-    To achieve this it writes individual files for each test and for the
-    metadata, and composes them at the end into a single file and removes the
-    intermediate files. When it tries to compose these files if it cannot read
-    a file it just ignores it, making the result atomic.
+    To achieve this it writes the metadata to a file and appends the tests to
+    a journal (see framework/backends/journal.py), and composes them at the
+    end into a single file and removes the intermediate files. A record of
+    the journal that cannot be read ends the journal, making the result
+    atomic.
+
+    Runs started before the journal existed wrote one file per test in a
+    tests folder, those files are still read on resume and finalize.
 
     """
     _file_extension = 'json'
 
+    __INCOMPLETE = json.dumps(results.TestResult(result=status.INCOMPLETE),
+                              default=piglit_encoder)
+
+    def __init__(self, dest, **kwargs):
+        super(JSONBackend, self).__init__(dest, **kwargs)
+        self._journal = journal.Writer(os.path.join(self._dest, JOURNAL))
+
     def initialize(self, metadata):
         """ Write boilerplate json code
 
@@ -108,11 +124,30 @@ class JSONBackend(FileBackend):
             f.flush()
             os.fsync(f.fileno())
 
-        # make the directory for the tests
-        try:
-            os.mkdir(os.path.join(self._dest, 'tests'))
-        except OSError:
-            pass
+        self._journal.open()
+
+    def share_with_processes(self):
+        # The journal is opened with O_APPEND, every process can append to
+        # the inherited descriptor.
+        self._journal.open()
+
+    @contextlib.contextmanager
+    def write_test(self, name):
+        """Write a test.
+
+        When this context manager is opened it appends a record with the
+        status incomplete to the journal, when it is called with the final
+        result it appends a record with that result.
+
+        """
+        def finish(val):
+            self._journal.append(journal.FINISHED, name,
+                                 json.dumps(val, default=piglit_encoder),
+                                 sync=options.OPTIONS.sync)
+
+        self._journal.append(journal.STARTED, name, self.__INCOMPLETE,
+                             sync=options.OPTIONS.sync)
+        yield finish
 
     def finalize(self, metadata=None):
         """ End json serialization and cleanup
@@ -121,93 +156,49 @@ class JSONBackend(FileBackend):
         containers that are still open and closes the file
 
         """
-        tests_dir = os.path.join(self._dest, 'tests')
-        file_list = sorted(
-            (f for f in os.listdir(tests_dir) if f.endswith('.json')),
-            key=lambda p: int(os.path.splitext(p)[0]))
-
-        # If jsonstreams is not present then build a complete tree of all of
-        # the data and write it with json.dump
-        if not _STREAMS:
-            # Create a dictionary that is full of data to be written to a
-            # single file
-            data = collections.OrderedDict()
-
-            # Load the metadata and put it into a dictionary
-            with open(os.path.join(self._dest, 'metadata.json'), 'r') as f:
-                data.update(json.load(f))
-
-            # If there is more metadata add it the dictionary
-            if metadata:
-                data.update(metadata)
-
-            # Add the tests to the dictionary
-            data['tests'] = collections.OrderedDict()
-
-            for test in file_list:
-                test = os.path.join(tests_dir, test)
-                if os.path.isfile(test):
-                    # Try to open the json snippets. If we fail to open a test
-                    # then throw the whole thing out. This gives us atomic
-                    # writes, the writing worked and is valid or it didn't
-                    # work.
-                    try:
-                        with open(test, 'r') as f:
-                            data['tests'].update(json.load(f))
-                    except ValueError:
-                        pass
-
-            if not data['tests']:
-                raise exceptions.PiglitUserError(
-                    'No tests were run, not writing a result file',
-                    exitcode=2)
-
-            data = results.TestrunResult.from_dict(data)
-
-            # write out the combined file. Use the compression writer from the
-            # FileBackend
-            with self._write_final(os.path.join(self._dest, 'results.json')) as f:
-                json.dump(data, f, default=piglit_encoder, indent=INDENT)
-
-        # Otherwise use jsonstreams to write the final dictionary. This uses an
-        # external library, but is slightly faster and uses considerably less
-        # memory that building a complete tree.
-        else:
-            encoder = functools.partial(json.JSONEncoder, default=piglit_encoder)
-
-            with self._write_final(os.path.join(self._dest, 'results.json')) as f:
-                with jsonstreams.Stream(jsonstreams.Type.object, fd=f, indent=4,
-                                        encoder=encoder, pretty=True) as s:
-                    s.write('__type__', 'TestrunResult')
-                    with open(os.path.join(self._dest, 'metadata.json'),
-                              'r') as n:
-                        s.iterwrite(json.load(n, object_pairs_hook=collections.OrderedDict).items())
-
-                    if metadata:
-                        s.iterwrite(metadata.items())
-
-                    with s.subobject('tests') as t:
-                        wrote = False
-                        for test in file_list:
-                            test = os.path.join(tests_dir, test)
-                            if os.path.isfile(test):
-                                try:
-                                    with open(test, 'r') as f:
-                                        a = json.load(f)
-                                except ValueError:
-                                    continue
-
-                                t.iterwrite(a.items())
-                                wrote = True
-
-                    if not wrote:
-                        raise exceptions.PiglitUserError(
-                            'No tests were run.',
-                            exitcode=2)
+        self._journal.close()
+
+        with open(os.path.join(self._dest, 'metadata.json'), 'r') as f:
+            meta = json.load(f, object_pairs_hook=collections.OrderedDict)
+        if metadata:
+            meta.update(metadata)
+
+        count, tests = _raw_tests(self._dest)
+        if not count:
+            raise exceptions.PiglitUserError(
+                'No tests were run, not writing a result file',
+                exitcode=2)
+
+        # The final file is streamed, only the totals and the tests being
+        # encoded are kept in memory. Use the compression writer from the
+        # FileBackend.
+        run = results.TestrunResult()
+        indent = ' ' * INDENT
+        with self._write_final(os.path.join(self._dest, 'results.json')) as f:
+            f.write('{\n')
+            f.write('{}"__type__": "TestrunResult",\n'.format(indent))
+            for key, value in meta.items():
+                f.write('{}{}: {},\n'.format(indent, json.dumps(key),
+                                             _dumps(value, 1)))
+
+            f.write('{}"tests": {{'.format(indent))
+            separator = '\n'
+            for name, text, result, subtests in _encode_tests(count, tests):
+                f.write('{}{}{}: {}'.format(separator, indent * 2,
+                                            json.dumps(name), text))
+                separator = ',\n'
+                run.add_to_totals(name, result, subtests)
+            f.write('\n{}}},\n'.format(indent))
+
+            f.write('{}"totals": {}\n}}\n'.format(indent,
+                                                  _dumps(run.totals, 1)))
 
         # Delete the temporary files
         os.unlink(os.path.join(self._dest, 'metadata.json'))
-        shutil.rmtree(os.path.join(self._dest, 'tests'))
+        if os.path.exists(os.path.join(self._dest, JOURNAL)):
+            os.unlink(os.path.join(self._dest, JOURNAL))
+        if os.path.exists(os.path.join(self._dest, 'tests')):
+            shutil.rmtree(os.path.join(self._dest, 'tests'))
 
     @staticmethod
     def _write(f, name, data):
@@ -224,20 +215,25 @@ def load_results(filename, compression_):
     "main"
 
     """
+    # The journal of a run in progress
+    if os.path.basename(filename) == JOURNAL:
+        return _resume(os.path.dirname(filename) or '.')
     # This will load any file or file-like thing. That would include pipes and
     # file descriptors
-    if not os.path.isdir(filename):
+    elif not os.path.isdir(filename):
         filepath = filename
     elif (os.path.exists(os.path.join(filename, 'metadata.json')) and
           not os.path.exists(os.path.join(
-              filename, 'results.json.' + compression_))):
+              filename,
+              'results.json' + compression.get_suffix(compression_)))):
         # We want to hit this path only if there isn't a
         # results.json.<compressions>, since otherwise we'll continually
         # regenerate values that we don't need to.
         return _resume(filename)
     else:
         # Look for a compressed result first, then a bare result.
-        for name in ['results.json.{}'.format(compression_), 'results.json']:
+        for name in ['results.json' + compression.get_suffix(compression_),
+                     'results.json']:
             if os.path.exists(os.path.join(filename, name)):
                 filepath = os.path.join(filename, name)
                 break
@@ -246,10 +242,7 @@ def load_results(filename, compression_):
                 'No results found in "{}" (compression: {})'.format(
                     filename, compression_))
 
-    assert compression_ in compression.COMPRESSORS, \
-        'unsupported compression type'
-
-    with compression.DECOMPRESSORS[compression_](filepath) as f:
+    with compression.get_decompressor(compression_)(filepath) as f:
         testrun = _load(f)
 
     return results.TestrunResult.from_dict(_update_results(testrun, filepath))
@@ -290,22 +283,110 @@ def _resume(results_dir):
     assert meta['results_version'] == CURRENT_JSON_VERSION, \
         "Old results version, resume impossible"
 
-    meta['tests'] = collections.OrderedDict()
+    meta['tests'] = collections.OrderedDict(_iter_tests(results_dir))
 
-    # Load all of the test names and added them to the test list
+    return results.TestrunResult.from_dict(meta)
+
+
+def _dumps(value, depth):
+    """Encode a value to be written at a depth of the final file."""
+    return json.dumps(value, default=piglit_encoder, indent=INDENT).replace(
+        '\n', '\n' + ' ' * INDENT * depth)
+
+
+def _encode_chunk(chunk):
+    """Encode a list of tests for the final file.
+
+    Return a list of the name of each test, its JSON, its status and the
+    statuses of its subtests.
+
+    """
+    encoded = []
+    for name, data in chunk:
+        test = results.TestResult.from_dict(json.loads(data))
+        encoded.append((name, _dumps(test, 2), str(test.result),
+                        [str(s) for s in test.subtests.values()]))
+    return encoded
+
+
+def _encode_tests(count, tests):
+    """Yield the encoded tests in order, see _encode_chunk.
+
+    Large runs are encoded by a pool of processes. At most two chunks per
+    process are in flight, so the memory used does not grow with the number
+    of tests.
+
+    """
+    chunks = iter(lambda: list(itertools.islice(tests, _CHUNK_SIZE)), [])
+    workers = os.cpu_count() or 1
+
+    if count < _PARALLEL_TESTS or workers == 1:
+        for chunk in chunks:
+            for each in _encode_chunk(chunk):
+                yield each
+        return
+
+    with multiprocessing.Pool(workers) as pool:
+        pending = collections.deque()
+        for chunk in chunks:
+            pending.append(pool.apply_async(_encode_chunk, (chunk, )))
+            while len(pending) > 2 * workers:
+                for each in pending.popleft().get():
+                    yield each
+        while pending:
+            for each in pending.popleft().get():
+                yield each
+
+
+def _raw_tests(results_dir):
+    """Return the number of tests of a run in progress and an iterator of
+    the name and the JSON of each.
+
+    The journal is scanned once for the latest record of every test, the
+    records are read when the iterator is consumed. The tests folder of a run
+    that was started without a journal is read first, tests in it that were
+    run again are skipped.
+
+    """
+    reader = None
+    offsets = collections.OrderedDict()
+    filename = os.path.join(results_dir, JOURNAL)
+    if os.path.exists(filename):
+        reader = journal.Reader(filename)
+        offsets = reader.latest()
+
+    legacy = collections.OrderedDict()
     tests_dir = os.path.join(results_dir, 'tests')
-    file_list = sorted(
-        (l for l in os.listdir(tests_dir) if l.endswith('.json')),
-        key=lambda p: int(os.path.splitext(p)[0]))
+    if os.path.isdir(tests_dir):
+        file_list = sorted(
+            (l for l in os.listdir(tests_dir) if l.endswith('.json')),
+            key=lambda p: int(os.path.splitext(p)[0]))
 
-    for file_ in file_list:
-        with open(os.path.join(tests_dir, file_), 'r') as f:
-            try:
-                meta['tests'].update(json.load(f))
-            except ValueError:
-                continue
+        for file_ in file_list:
+            with open(os.path.join(tests_dir, file_), 'r') as f:
+                try:
+                    tests = json.load(f)
+                except ValueError:
+                    continue
+            for name, test in tests.items():
+                if name not in offsets:
+                    legacy[name] = json.dumps(test)
 
-    return results.TestrunResult.from_dict(meta)
+    def iterate():
+        for each in legacy.items():
+            yield each
+        if reader is not None:
+            for each in reader.tests(offsets):
+                yield each
+
+    return len(legacy) + len(offsets), iterate()
+
+
+def _iter_tests(results_dir):
+    """Yield the name and the data of every test of a run in progress."""
+    _, tests = _raw_tests(results_dir)
+    for name, data in tests:
+        yield name, json.loads(data, object_pairs_hook=collections.OrderedDict)
 
 
 def _update_results(results, filepath):
@@ -423,7 +504,7 @@ def _update_nine_to_ten(result):
 
 
 REGISTRY = Registry(
-    extensions=['.json'],
+    extensions=['.json', '.journal'],
     backend=JSONBackend,
     load=load_results,
     meta=set_meta,
@@ -0,0 +1,278 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Module providing an SQLite backend for piglit.
+
+The JSON backend appends every test to a journal and composes the final
+result from it when the run is finished. This backend writes all tests into
+one SQLite database, results.db in the results folder, which is also the final
+result.
+
+The database is in write-ahead log mode while tests are written. The
+incomplete status and the final result of each test are committed in
+batches. With --sync the incomplete status is committed before the test
+runs, so a test that takes the machine down is known on resume. A run that
+was interrupted is resumed in place, resumed tests keep their place.
+
+Tests are rows of the tests table, with the JSON of the TestResult in data
+and an index on the status in result, so they can also be queried directly:
+
+    sqlite3 results/results.db "SELECT name FROM tests WHERE result = 'fail'"
+"""
+
+import collections
+import contextlib
+import json
+import os
+import sqlite3
+import threading
+import time
+
+from framework import exceptions, options, results
+from framework.status import INCOMPLETE
+from .abstract import Backend
+from .json import CURRENT_JSON_VERSION, piglit_encoder
+from .register import Registry
+
+__all__ = [
+    'REGISTRY',
+    'SQLiteBackend',
+]
+
+# The name of the database in the results folder
+DATABASE = 'results.db'
+
+# Finished tests are committed at least this often
+_BATCH_SIZE = 64
+_BATCH_SECONDS = 1.0
+
+_SCHEMA = [
+    'CREATE TABLE IF NOT EXISTS metadata ('
+    'key TEXT PRIMARY KEY, value TEXT NOT NULL)',
+    'CREATE TABLE IF NOT EXISTS tests ('
+    'id INTEGER PRIMARY KEY, name TEXT NOT NULL UNIQUE, '
+    'result TEXT NOT NULL, data TEXT NOT NULL)',
+    'CREATE INDEX IF NOT EXISTS tests_result ON tests (result)',
+]
+
+_INCOMPLETE = json.dumps(results.TestResult(result=INCOMPLETE),
+                         default=piglit_encoder)
+
+
+def _connect(filename):
+    conn = sqlite3.connect(filename, timeout=60, check_same_thread=False)
+    conn.execute('PRAGMA journal_mode = WAL')
+    conn.execute('PRAGMA synchronous = {}'.format(
+        'FULL' if options.OPTIONS.sync else 'NORMAL'))
+    for statement in _SCHEMA:
+        conn.execute(statement)
+    conn.commit()
+    return conn
+
+
+def _write_metadata(conn, metadata):
+    conn.executemany(
+        'INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?)',
+        ((k, json.dumps(v, default=piglit_encoder))
+         for k, v in metadata.items()))
+
+
+def _database(filename):
+    """Find the database of a results folder or of one of its files."""
+    if os.path.isdir(filename):
+        return os.path.join(filename, DATABASE)
+    for suffix in ['-wal', '-shm']:
+        if filename.endswith(suffix):
+            return filename[:-len(suffix)]
+    return filename
+
+
+class SQLiteBackend(Backend):
+    """Piglit's SQLite backend.
+
+    Tests can be written from several threads, and from forked processes
+    after share_with_processes() was called.
+
+    Arguments:
+    dest -- the results folder
+
+    """
+    def __init__(self, dest, **kwargs):
+        self._file = os.path.join(dest, DATABASE)
+        self._lock = threading.Lock()
+        self._conn = None
+        self._pid = None
+        self._pending = 0
+        self._last_commit = time.monotonic()
+        self._batch_size = _BATCH_SIZE
+
+    def _connection(self):
+        # A connection cannot be used across a fork, every process opens its
+        # own.
+        if self._conn is None or self._pid != os.getpid():
+            self._conn = _connect(self._file)
+            self._pid = os.getpid()
+        return self._conn
+
+    def _commit(self):
+        self._conn.commit()
+        self._pending = 0
+        self._last_commit = time.monotonic()
+
+    def _execute(self, statement, args, commit):
+        with self._lock:
+            self._connection().execute(statement, args)
+            self._wrote(commit)
+
+    def _wrote(self, commit):
+        """Count a write, and commit when the batch is done."""
+        self._pending += 1
+        if (commit or self._pending >= self._batch_size or
+                time.monotonic() - self._last_commit > _BATCH_SECONDS):
+            self._commit()
+
+    def initialize(self, metadata):
+        """Create the database and write the metadata into it."""
+        metadata['results_version'] = CURRENT_JSON_VERSION
+        with self._lock:
+            conn = self._connection()
+            _write_metadata(conn, metadata)
+            self._commit()
+
+    def share_with_processes(self):
+        # Worker processes exit without finalizing, so nothing may be left
+        # uncommitted in them.
+        with self._lock:
+            if self._conn is not None:
+                self._commit()
+                self._conn.close()
+                self._conn = None
+            self._batch_size = 1
+
+    def finalize(self, metadata=None):
+        """Write the final metadata and turn the database into a single file.
+        """
+        with self._lock:
+            conn = self._connection()
+            if metadata:
+                _write_metadata(conn, metadata)
+            self._commit()
+
+            count = conn.execute('SELECT COUNT(*) FROM tests').fetchone()[0]
+            if not count:
+                raise exceptions.PiglitUserError(
+                    'No tests were run, not writing a result file',
+                    exitcode=2)
+
+            # Leaving WAL mode merges the log into the database and removes
+            # it, a finished run is a single file that can be copied. This
+            # fails while someone else has the database open, which leaves a
+            # valid database in WAL mode.
+            try:
+                conn.execute('PRAGMA journal_mode = DELETE')
+            except sqlite3.OperationalError:
+                pass
+            conn.close()
+            self._conn = None
+
+    @contextlib.contextmanager
+    def write_test(self, name):
+        """Write a test.
+
+        The incomplete status and the final result are committed with the
+        batch they are in, or by finalize(). With --sync the incomplete status
+        is committed right away.
+
+        """
+        def finish(val):
+            self._execute(
+                'UPDATE tests SET result = ?, data = ? WHERE name = ?',
+                (str(val.result), json.dumps(val, default=piglit_encoder),
+                 name),
+                commit=False)
+
+        # A resumed run updates the incomplete row of the test, which keeps
+        # its id and so its place in the results. This is an UPDATE and an
+        # INSERT rather than an upsert, which needs SQLite 3.24.
+        with self._lock:
+            conn = self._connection()
+            if not conn.execute(
+                    'UPDATE tests SET result = ?, data = ? WHERE name = ?',
+                    (str(INCOMPLETE), _INCOMPLETE, name)).rowcount:
+                conn.execute(
+                    'INSERT INTO tests (name, result, data) VALUES (?, ?, ?)',
+                    (name, str(INCOMPLETE), _INCOMPLETE))
+            self._wrote(options.OPTIONS.sync)
+        yield finish
+
+
+def load_results(filename, compression_):  # pylint: disable=unused-argument
+    """Load a results database, finished or not, as a TestrunResult."""
+    filename = _database(filename)
+    if not os.path.exists(filename):
+        raise exceptions.PiglitFatalError(
+            'No results found in "{}"'.format(filename))
+
+    with contextlib.closing(sqlite3.connect(filename, timeout=60)) as conn:
+        data = {k: json.loads(v) for k, v in
+                conn.execute('SELECT key, value FROM metadata')}
+        data['tests'] = collections.OrderedDict(
+            (n, json.loads(d)) for n, d in
+            conn.execute('SELECT name, data FROM tests ORDER BY id'))
+
+    return results.TestrunResult.from_dict(data)
+
+
+def set_meta(results_):
+    """Set sqlite specific metadata on a TestrunResult."""
+    results_.results_version = CURRENT_JSON_VERSION
+
+
+def write_results(results_, file_):
+    """Write a TestrunResult into a new database."""
+    file_ = _database(file_)
+    if os.path.exists(file_):
+        os.unlink(file_)
+
+    data = results_.to_json()
+    tests = data.pop('tests')
+    with contextlib.closing(sqlite3.connect(file_)) as conn:
+        for statement in _SCHEMA:
+            conn.execute(statement)
+        _write_metadata(conn, data)
+        conn.executemany(
+            'INSERT INTO tests (name, result, data) VALUES (?, ?, ?)',
+            ((n, str(t['result']), json.dumps(t, default=piglit_encoder))
+             for n, t in tests.items()))
+        conn.commit()
+
+    return True
+
+
+REGISTRY = Registry(
+    # An interrupted run still has the write-ahead log next to the database
+    extensions=['.db', '.db-wal', '.db-shm'],
+    backend=SQLiteBackend,
+    load=load_results,
+    meta=set_meta,
+    write=write_results,
+)
@@ -0,0 +1,207 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Module for running tests as soon as the resources they need are free.
+
+Each test declares the resources it needs as tokens, which are just names.
+A test holds some tokens shared, with any number of other tests, and some
+exclusively, with no other test holding the same token at all. For example
+all GL tests share the GPU token, while a performance test needs it for
+itself.
+
+Tests are started in the order they were submitted, except that a test
+whose tokens are busy doesn't hold up tests that need other tokens. It does
+hold up later tests that want one of its tokens, so that an exclusive test
+is not starved by a stream of tests sharing the same token.
+"""
+
+import collections
+import itertools
+import threading
+import traceback
+
+__all__ = [
+    'DISPLAY',
+    'GPU',
+    'Executor',
+    'TokenQueue',
+]
+
+# The whole GPU. Shared by tests that render, exclusive for tests that need
+# it idle, like performance tests.
+GPU = 'gpu'
+
+# The display, for tests that need to render to a visible window.
+DISPLAY = 'display'
+
+
+class TokenQueue(object):
+    """A queue of items that need tokens, and the tokens currently held.
+
+    Items with the same tokens are kept in the same FIFO, so choosing the
+    next item only has to look at the head of each FIFO.
+
+    """
+    def __init__(self):
+        self._fifos = collections.OrderedDict()
+        self._counter = itertools.count()
+        self._shared = collections.Counter()
+        self._exclusive = set()
+        self._len = 0
+
+    def __len__(self):
+        return self._len
+
+    def push(self, item, shared=frozenset(), exclusive=frozenset()):
+        """Queue an item that needs the given tokens."""
+        key = (frozenset(shared) - frozenset(exclusive), frozenset(exclusive))
+        fifo = self._fifos.setdefault(key, collections.deque())
+        fifo.append((next(self._counter), item))
+        self._len += 1
+
+    def _free(self, shared, exclusive):
+        return (not (shared & self._exclusive) and
+                not (exclusive & self._exclusive) and
+                not any(self._shared[t] for t in exclusive))
+
+    def pop(self, exclusive_only=False):
+        """Take the tokens of the next item whose tokens are free.
+
+        Return a tuple of the item and its shared and exclusive tokens, which
+        must be given back to release() later, or None if no item can run.
+
+        Arguments:
+        exclusive_only -- only consider items that need a token exclusively
+
+        """
+        heads = sorted((fifo[0][0], key) for key, fifo in self._fifos.items()
+                       if fifo)
+        wanted_shared = set()
+        wanted_exclusive = set()
+
+        for _, key in heads:
+            shared, exclusive = key
+            if exclusive_only and not exclusive:
+                continue
+            if (self._free(shared, exclusive) and
+                    not (shared & wanted_exclusive) and
+                    not (exclusive & (wanted_shared | wanted_exclusive))):
+                _, item = self._fifos[key].popleft()
+                self._len -= 1
+                self._shared.update(shared)
+                self._exclusive.update(exclusive)
+                return item, shared, exclusive
+
+            # Tests after this one must not take its tokens.
+            wanted_shared |= shared
+            wanted_exclusive |= exclusive
+
+        return None
+
+    def release(self, shared, exclusive):
+        """Give back the tokens of an item returned by pop()."""
+        self._shared.subtract(shared)
+        self._exclusive.difference_update(exclusive)
+
+
+class Executor(object):
+    """Run functions on a pool of threads as soon as their tokens are free.
+
+    The interface follows multiprocessing.Pool, with the tokens as
+    additional arguments to apply_async.
+
+    Arguments:
+    jobs -- the number of threads running any function
+    exclusive_jobs -- the number of additional threads that only run
+                      functions needing a token exclusively, so that these
+                      don't take a thread from the others
+
+    """
+    def __init__(self, jobs, exclusive_jobs=0):
+        self._queue = TokenQueue()
+        self._cond = threading.Condition()
+        self._closed = False
+        self._terminated = False
+        self._threads = [
+            threading.Thread(target=self._work, args=(i >= jobs,),
+                             daemon=True)
+            for i in range(jobs + exclusive_jobs)]
+        for thread in self._threads:
+            thread.start()
+
+    def apply_async(self, func, args=(), shared=frozenset(),
+                    exclusive=frozenset()):
+        """Queue func(*args) to run while holding the tokens."""
+        with self._cond:
+            self._queue.push((func, args), shared, exclusive)
+            # The thread woken by notify() may not be allowed to run it.
+            self._cond.notify_all()
+
+    def _next(self, exclusive_only):
+        """Wait for and return the next job to run, or None when done."""
+        with self._cond:
+            while not self._terminated:
+                job = self._queue.pop(exclusive_only)
+                if job is not None:
+                    return job
+                if self._closed and not self._queue:
+                    # Wake up the other threads, they are done too.
+                    self._cond.notify_all()
+                    return None
+                self._cond.wait()
+            return None
+
+    def _work(self, exclusive_only):
+        while True:
+            job = self._next(exclusive_only)
+            if job is None:
+                return
+
+            (func, args), shared, exclusive = job
+            try:
+                func(*args)
+            except Exception:  # pylint: disable=broad-except
+                # Like in multiprocessing.Pool a failing job doesn't stop
+                # the thread, but don't hide the error.
+                traceback.print_exc()
+            finally:
+                with self._cond:
+                    self._queue.release(shared, exclusive)
+                    self._cond.notify_all()
+
+    def close(self):
+        """Don't accept new jobs, the threads exit once all are done."""
+        with self._cond:
+            self._closed = True
+            self._cond.notify_all()
+
+    def terminate(self):
+        """Drop the queued jobs, the running ones are not interrupted."""
+        with self._cond:
+            self._terminated = True
+            self._cond.notify_all()
+
+    def join(self):
+        """Wait for the threads to exit, after close() or terminate()."""
+        for thread in self._threads:
+            if thread is not threading.current_thread():
+                thread.join()
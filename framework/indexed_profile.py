@@ -0,0 +1,258 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Module for the indexed profile format written by tests/serializer.py.
+
+A gzipped XML profile has to be parsed from the start to count its tests or
+to find one of them. An indexed profile can be read in pieces instead:
+
+    {"format": "piglit-profile", "version": 2, "name": "quick"}
+    <record blocks>
+    <index blocks>
+    {"records_end": <offset>, "index": [[<first name>, <offset>], ...]}
+    <offset of the directory line> <number of tests>
+
+Each block is a separate zlib stream, so it can be decompressed on its own.
+The record blocks hold one JSON record per test, in profile order, one per
+line. The index blocks hold one "<test name>\t<record block offset>\t<line
+offset in the block>" line per test, sorted by name. The directory line
+lists the first name and the offset of each index block.
+
+The last line has a fixed width, so the number of tests is read without
+touching the records, and a test is found by a binary search of the
+directory, which only decompresses one index block and one record block.
+
+Each record is a JSON object with the test name, the test type, and the
+arguments of the test class as repr() strings, like the options of the XML
+format.
+"""
+
+import bisect
+import json
+import os
+import zlib
+
+from framework import exceptions
+
+__all__ = [
+    'EXTENSION',
+    'Reader',
+    'write',
+]
+
+EXTENSION = '.profile'
+
+_FORMAT = 'piglit-profile'
+_VERSION = 2
+
+_TRAILER = '{:020d} {:020d}\n'
+_TRAILER_SIZE = len(_TRAILER.format(0, 0))
+
+# The uncompressed size after which a block is closed. Bigger blocks
+# compress better, smaller ones are faster to look a single test up in.
+_BLOCK_SIZE = 64 * 1024
+
+
+class _BlockWriter(object):
+    """Collects lines and writes them to f as zlib compressed blocks."""
+
+    def __init__(self, f):
+        self._file = f
+        self._lines = []
+        self._size = 0
+        self.offset = f.tell()
+
+    def add(self, line):
+        """Add a line, return the offset of its block and its offset in it.
+        """
+        pos = self._size
+        self._lines.append(line)
+        self._size += len(line)
+        return self.offset, pos
+
+    def empty(self):
+        return not self._lines
+
+    def full(self):
+        return self._size >= _BLOCK_SIZE
+
+    def flush(self):
+        """Write the current block, if any, and start a new one."""
+        if self._lines:
+            self._file.write(zlib.compress(b''.join(self._lines), 9))
+            self._lines = []
+            self._size = 0
+            self.offset = self._file.tell()
+
+
+def write(filename, name, records):
+    """Write an indexed profile.
+
+    Arguments:
+    filename -- the file to write
+    name -- the name of the profile
+    records -- an iterable of record dicts, each with a 'name'
+
+    """
+    index = []
+    with open(filename, 'wb') as f:
+        f.write(json.dumps({'format': _FORMAT, 'version': _VERSION,
+                            'name': name}).encode('utf-8') + b'\n')
+
+        blocks = _BlockWriter(f)
+        for record in records:
+            block, pos = blocks.add(
+                json.dumps(record, sort_keys=True).encode('utf-8') + b'\n')
+            index.append((record['name'].encode('utf-8'), block, pos))
+            if blocks.full():
+                blocks.flush()
+        blocks.flush()
+        records_end = f.tell()
+
+        index.sort()
+        directory = []
+        blocks = _BlockWriter(f)
+        for key, block, pos in index:
+            if blocks.empty():
+                directory.append([key.decode('utf-8'), blocks.offset])
+            blocks.add(b'%s\t%d\t%d\n' % (key, block, pos))
+            if blocks.full():
+                blocks.flush()
+        blocks.flush()
+
+        directory_start = f.tell()
+        f.write(json.dumps({'records_end': records_end,
+                            'index': directory}).encode('utf-8') + b'\n')
+        f.write(_TRAILER.format(directory_start, len(index)).encode('ascii'))
+
+
+class Reader(object):
+    """Reads an indexed profile.
+
+    Only the header, the directory and the trailer are read when the Reader
+    is created, blocks are read when they are iterated or looked up. Use as
+    a context manager, or call close().
+
+    """
+    def __init__(self, filename):
+        self.filename = filename
+        try:
+            self._file = open(filename, 'rb')
+        except OSError as e:
+            raise exceptions.PiglitFatalError(
+                'Cannot open profile "{}": {}'.format(filename, e))
+        try:
+            header = json.loads(self._file.readline().decode('utf-8'))
+            if (header.get('format') != _FORMAT or
+                    header.get('version') != _VERSION):
+                raise ValueError('unsupported format')
+            self.name = header['name']
+            self._records_start = self._file.tell()
+
+            self._file.seek(-_TRAILER_SIZE, os.SEEK_END)
+            start, count = self._file.read().split()
+            self.count = int(count)
+
+            self._file.seek(int(start))
+            directory = json.loads(self._file.readline().decode('utf-8'))
+            self._records_end = directory['records_end']
+            self._index_keys = [k.encode('utf-8')
+                                for k, _ in directory['index']]
+            self._index_offsets = [o for _, o in directory['index']]
+        except (ValueError, KeyError, AttributeError, OSError) as e:
+            self._file.close()
+            raise exceptions.PiglitFatalError(
+                'Cannot read profile "{}": {}'.format(filename, e))
+
+        # The last block read, as (offset, data, end). Tests of a list are
+        # often next to each other.
+        self._last = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def close(self):
+        self._file.close()
+
+    def __len__(self):
+        return self.count
+
+    def _read_block(self, offset):
+        """Return the decompressed block at offset and the offset after it.
+        """
+        if self._last is not None and self._last[0] == offset:
+            return self._last[1:]
+
+        self._file.seek(offset)
+        decompressor = zlib.decompressobj()
+        chunks = []
+        end = offset
+        while not decompressor.eof:
+            chunk = self._file.read(_BLOCK_SIZE // 4)
+            if not chunk:
+                raise exceptions.PiglitFatalError(
+                    'Cannot read profile "{}": truncated block'.format(
+                        self.filename))
+            chunks.append(decompressor.decompress(chunk))
+            end += len(chunk)
+        end -= len(decompressor.unused_data)
+
+        self._last = (offset, b''.join(chunks), end)
+        return self._last[1:]
+
+    def __iter__(self):
+        """Yield every record in profile order."""
+        pos = self._records_start
+        while pos < self._records_end:
+            data, pos = self._read_block(pos)
+            for line in data.splitlines():
+                yield json.loads(line.decode('utf-8'))
+
+    def _find(self, key):
+        """Return the record block offset and line offset of key, or None.
+        """
+        i = bisect.bisect_right(self._index_keys, key) - 1
+        if i < 0:
+            return None
+        data, _ = self._read_block(self._index_offsets[i])
+        for line in data.splitlines():
+            k, block, pos = line.rsplit(b'\t', 2)
+            if k == key:
+                return int(block), int(pos)
+            if k > key:
+                break
+        return None
+
+    def get(self, name):
+        """Return the record of the test name, or None."""
+        found = self._find(name.encode('utf-8'))
+        if found is None:
+            return None
+        data, _ = self._read_block(found[0])
+        end = data.index(b'\n', found[1])
+        return json.loads(data[found[1]:end].decode('utf-8'))
+
+    def __contains__(self, name):
+        return self._find(name.encode('utf-8')) is not None
@@ -46,6 +46,13 @@ class _Options(object):  # pylint: disable=too-many-instance-attributes
     valgrind -- True if valgrind is to be used
     env -- environment variables set for each test before run
     deqp_mustpass -- True to enable the use of the deqp mustpass list feature.
+    perf_baseline -- results file to compare performance measurements against
+    perf_tolerance -- relative drop of a measurement that is a warn
+    perf_fail_tolerance -- relative drop of a measurement that is a fail
+    capabilities -- file caching the wflinfo output used for fast skipping
+    zygote -- True to start tests through piglit-zygote when possible
+    schedule_from -- results file whose test durations order the run
+    processes -- number of worker processes the tests run in
     """
 
     def __init__(self):
@@ -56,6 +63,13 @@ class _Options(object):  # pylint: disable=too-many-instance-attributes
         self.process_isolation = True
         self.jobs = None
         self.force_glsl = False
+        self.perf_baseline = None
+        self.perf_tolerance = 0.05
+        self.perf_fail_tolerance = 0.10
+        self.capabilities = None
+        self.zygote = False
+        self.schedule_from = None
+        self.processes = 1
 
         # env is used to set some base environment variables that are not going
         # to change across runs, without sending them to os.environ which is
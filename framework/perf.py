@@ -0,0 +1,181 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+"""Module for comparing performance measurements against a baseline.
+
+Performance tests report one or more named measurements, each a rate (higher
+is better) and the standard deviation of the samples it was computed from.
+A measurement is a regression if it dropped by more than the tolerance
+compared to the baseline, and by more than the measurement noise allows.
+
+The baseline is any piglit results file that contains measurements for the
+same tests, usually a previous run of the perf_gl profile.
+"""
+
+import math
+import threading
+
+from framework import status
+
+__all__ = [
+    'Baseline',
+    'Comparison',
+    'compare',
+    'get_baseline',
+]
+
+# How many standard deviations a change must exceed to not be noise
+SIGMA = 2.0
+
+
+class Comparison(object):
+    """The comparison of a single measurement against its baseline."""
+    __slots__ = ['name', 'base', 'current', 'ratio', 'overlap', 'status']
+
+    def __init__(self, name, base, current, ratio, overlap, status_):
+        self.name = name
+        self.base = base
+        self.current = current
+        self.ratio = ratio
+        self.overlap = overlap
+        self.status = status_
+
+
+def _interval(measurement):
+    spread = SIGMA * measurement.get('stddev', 0.0)
+    return measurement['rate'] - spread, measurement['rate'] + spread
+
+
+def compare(name, base, current, tolerance, fail_tolerance):
+    """Compare two measurements and return a Comparison.
+
+    Arguments:
+    name -- the name of the measurement
+    base -- the baseline measurement, a dict with 'rate' and 'stddev'
+    current -- the new measurement, a dict with 'rate' and 'stddev'
+    tolerance -- the relative drop above which the status is warn
+    fail_tolerance -- the relative drop above which the status is fail
+
+    """
+    base_rate = base['rate']
+    rate = current['rate']
+
+    if base_rate <= 0:
+        return Comparison(name, base, current, float('inf'), False,
+                          status.PASS)
+
+    ratio = rate / base_rate
+    drop = 1.0 - ratio
+
+    # The relative noise of the difference of the two measurements.
+    noise = SIGMA * math.sqrt(base.get('stddev', 0.0) ** 2 +
+                              current.get('stddev', 0.0) ** 2) / base_rate
+
+    base_lo, base_hi = _interval(base)
+    cur_lo, cur_hi = _interval(current)
+    overlap = cur_lo <= base_hi and base_lo <= cur_hi
+
+    if drop > max(fail_tolerance, noise):
+        stat = status.FAIL
+    elif drop > max(tolerance, noise):
+        stat = status.WARN
+    else:
+        stat = status.PASS
+
+    return Comparison(name, base, current, ratio, overlap, stat)
+
+
+class Baseline(object):
+    """Measurements of a previous run, and the policy to compare against it.
+
+    Arguments:
+    results -- a TestrunResult to take the baseline measurements from
+
+    Keyword Arguments:
+    tolerance -- the relative drop above which a measurement warns
+    fail_tolerance -- the relative drop above which a measurement fails
+
+    """
+    def __init__(self, results, tolerance=0.05, fail_tolerance=0.10):
+        self.tolerance = tolerance
+        self.fail_tolerance = fail_tolerance
+        self.perf = {n: r.perf for n, r in results.tests.items() if r.perf}
+
+    def compare(self, name, result):
+        """Compare the measurements of a result against the baseline.
+
+        Return a list of Comparison objects, one for each measurement that
+        exists in both the baseline and the result. Measurements without a
+        baseline are not a regression.
+
+        """
+        base = self.perf.get(name, {})
+        return [compare(m, base[m], result.perf[m], self.tolerance,
+                        self.fail_tolerance)
+                for m in result.perf if m in base]
+
+    def apply(self, name, result):
+        """Update the status of a result based on its measurements.
+
+        A test that already failed keeps its status, otherwise the status
+        becomes the worst status of its measurements. A description of every
+        regression is appended to the test output.
+
+        """
+        comparisons = self.compare(name, result)
+        regressions = [c for c in comparisons if c.status != status.PASS]
+        if not regressions:
+            return
+
+        lines = ['perf: {}: {:.4g} vs {:.4g} baseline ({:+.1f}%): {}'.format(
+            c.name, c.current['rate'], c.base['rate'],
+            (c.ratio - 1.0) * 100, c.status)
+                 for c in sorted(regressions, key=lambda c: c.ratio)]
+        result.out = '\n'.join([result.out] + lines)
+
+        if result.result == status.PASS:
+            result.result = max(c.status for c in regressions)
+
+
+_BASELINE = None
+_BASELINE_LOCK = threading.Lock()
+
+
+def get_baseline():
+    """Return the Baseline configured in OPTIONS, or None.
+
+    The baseline is loaded only once per run, since tests run from several
+    threads this is protected by a lock.
+
+    """
+    global _BASELINE  # pylint: disable=global-statement
+    from framework import backends
+    from framework.options import OPTIONS
+
+    if not OPTIONS.perf_baseline:
+        return None
+
+    with _BASELINE_LOCK:
+        if _BASELINE is None:
+            _BASELINE = Baseline(backends.load(OPTIONS.perf_baseline),
+                                 OPTIONS.perf_tolerance,
+                                 OPTIONS.perf_fail_tolerance)
+        return _BASELINE
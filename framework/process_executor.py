@@ -0,0 +1,179 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Module for running tests in several worker processes.
+
+Tests normally run on threads of the piglit process. At a high number of
+jobs the Python side of running a test (starting it, decoding its output,
+interpreting and encoding the result) is bound by the GIL, and the CPUs
+sit idle. The ProcessExecutor forks worker processes instead, each running
+its share of the jobs on threads.
+
+The workers inherit the list of tests when they are forked, and take the
+next one by incrementing a shared index, so tests are never pickled. They
+write the results to the backend themselves. The log stays in the main
+process, the workers send it the start and the status of each test.
+"""
+
+import itertools
+import multiprocessing
+import os
+import threading
+import traceback
+
+__all__ = [
+    'ProcessExecutor',
+]
+
+
+class _RemoteLog(object):
+    """A log of a worker process that forwards to the main process."""
+    _counter = itertools.count()
+
+    def __init__(self, queue):
+        self._queue = queue
+        self._id = (os.getpid(), next(self._counter))
+        self._started = False
+        self._logged = False
+
+    def start(self, name):
+        self._started = True
+        self._queue.put(('start', self._id, name))
+
+    def log(self, status):
+        self._logged = True
+        self._queue.put(('log', self._id, status))
+
+    def fail(self, name):
+        """End a test that raised on the log, so that it is counted."""
+        if not self._started:
+            self.start(name)
+        if not self._logged:
+            self.log('crash')
+
+
+class ProcessExecutor(object):
+    """Run tests in forked worker processes.
+
+    The workers are forked by the constructor, so it should be called before
+    the main process starts any threads of its own.
+
+    Arguments:
+    tests -- a list of (name, Test, profile) tuples
+    run_test -- called as run_test(name, test, profile, log) in a worker to
+                run a test and write its result. It returns a message if the
+                run must be aborted, None otherwise.
+    log_manager -- the log.LogManager of the run
+    processes -- the number of worker processes
+    threads -- the number of threads in each worker process
+
+    """
+    def __init__(self, tests, run_test, log_manager, processes, threads):
+        if 'fork' not in multiprocessing.get_all_start_methods():
+            raise NotImplementedError('running tests in several processes '
+                                      'requires fork()')
+        ctx = multiprocessing.get_context('fork')
+
+        self._tests = tests
+        self._run_test = run_test
+        self._log_manager = log_manager
+        self._threads = threads
+        self._next = ctx.Value('q', 0)
+        self._abort = ctx.Event()
+        self._queue = ctx.SimpleQueue()
+        self._abort_message = None
+
+        self._workers = [ctx.Process(target=self._worker, daemon=True)
+                         for _ in range(processes)]
+        for worker in self._workers:
+            worker.start()
+
+        self._forwarder = threading.Thread(target=self._forward_log,
+                                           daemon=True)
+        self._forwarder.start()
+
+    def _take(self):
+        """Return the index of the next test to run, or None."""
+        if self._abort.is_set():
+            return None
+        with self._next.get_lock():
+            i = self._next.value
+            self._next.value += 1
+        return i if i < len(self._tests) else None
+
+    def _worker_thread(self):
+        while True:
+            i = self._take()
+            if i is None:
+                return
+
+            name, test, profile = self._tests[i]
+            log = _RemoteLog(self._queue)
+            try:
+                message = self._run_test(name, test, profile, log)
+            except Exception:  # pylint: disable=broad-except
+                traceback.print_exc()
+                log.fail(name)
+                continue
+
+            if message is not None:
+                self._abort.set()
+                self._queue.put(('abort', None, message))
+
+    def _worker(self):
+        """Main function of a worker process."""
+        threads = [threading.Thread(target=self._worker_thread)
+                   for _ in range(self._threads)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+    def _forward_log(self):
+        """Replay the log messages of the workers on the real log."""
+        logs = {}
+        while True:
+            message = self._queue.get()
+            if message is None:
+                return
+
+            kind, id_, arg = message
+            if kind == 'start':
+                logs[id_] = self._log_manager.get()
+                logs[id_].start(arg)
+            elif kind == 'log':
+                logs.pop(id_).log(arg)
+            else:
+                assert kind == 'abort'
+                self._abort_message = arg
+
+    def join(self):
+        """Wait for the workers to run all tests.
+
+        Return the message of a test that aborted the run, or None.
+
+        """
+        for worker in self._workers:
+            worker.join()
+        self._queue.put(None)
+        self._forwarder.join()
+        return self._abort_message
@@ -32,6 +32,7 @@ import ast
 import collections
 import contextlib
 import copy
+import datetime
 import gzip
 import importlib
 import itertools
@@ -39,16 +40,18 @@ import multiprocessing
 import multiprocessing.dummy
 import os
 import re
+import time
 import xml.etree.ElementTree as et
 
-from framework import grouptools, exceptions, status
+from framework import (grouptools, exceptions, executor, indexed_profile,
+                       process_executor, schedule, status)
 from framework.dmesg import get_dmesg
 from framework.log import LogManager
 from framework.monitoring import Monitoring
 from framework.test.base import Test, DummyTest
 from framework.test.piglit_test import (
-    PiglitCLTest, PiglitGLTest, ASMParserTest, BuiltInConstantsTest,
-    CLProgramTester, VkRunnerTest, ROOT_DIR,
+    PiglitCLTest, PiglitGLTest, PiglitPerfTest, ASMParserTest,
+    BuiltInConstantsTest, CLProgramTester, VkRunnerTest, ROOT_DIR,
 )
 from framework.test.shader_test import ShaderTest, MultiShaderTest
 from framework.test.glsl_parser_test import GLSLParserTest
@@ -64,6 +67,94 @@ __all__ = [
 ]
 
 
+# Characters that make a filter a regular expression rather than a string.
+_REGEX_SPECIAL = frozenset('.^$*+?{}[]\\|()')
+
+# Filters that change the meaning of other filters when they are joined into
+# one alternation: back references, named groups and global inline flags.
+_UNCOMBINABLE = re.compile(r'\\[1-9]|\\g|\(\?P|\(\?[aiLmsux]+\)')
+
+
+def _split_filter(filter_):
+    """Split a filter into (start, prefix, tail).
+
+    start is True if the filter is anchored with ^, prefix is the fixed
+    string the filter starts with, and tail is the regular expression that
+    has to match after it. The tail of a fixed string is empty.
+    """
+    start = filter_.startswith('^')
+    body = filter_[1:] if start else filter_
+    chars = []
+    offsets = []
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c == '\\':
+            # \. and friends are literal, \d and friends are not
+            if i + 1 == len(body) or body[i + 1].isalnum():
+                break
+            chars.append(body[i + 1])
+            offsets.append(i)
+            i += 2
+            continue
+        if c in _REGEX_SPECIAL:
+            break
+        chars.append(c)
+        offsets.append(i)
+        i += 1
+
+    tail = body[i:]
+    if '|' in tail:
+        # The prefix and ^ would only belong to the first alternative.
+        return False, '', filter_
+    if chars and tail[:1] in ('*', '+', '?', '{'):
+        # The quantifier applies to the last character.
+        chars.pop()
+        tail = body[offsets.pop():]
+    prefix = ''.join(chars)
+    if all(ord(c) < 128 for c in prefix):
+        prefix = prefix.lower()
+    return start, prefix, tail
+
+
+def _trie_regex(entries):
+    """Build a regex matching any of (prefix, tail) entries.
+
+    The prefixes are merged into a trie, so that only the entries sharing the
+    start of a name are tried. An entry with an empty tail matches as soon
+    as its prefix does, the end of the match doesn't matter for filtering so
+    longer entries with the same prefix are dropped.
+    """
+    trie = {}
+    for prefix, tail in entries:
+        node = trie
+        for c in prefix:
+            node = node.setdefault(c, {})
+        node.setdefault('', set()).add(tail)
+
+    def build(node):
+        parts = []
+        while True:
+            tails = node.get('', set())
+            if '' in tails:
+                return ''.join(parts)
+            branches = sorted(k for k in node if k)
+            if tails or len(branches) != 1:
+                break
+            parts.append(re.escape(branches[0]))
+            node = node[branches[0]]
+
+        alts = [re.escape(k) + build(node[k]) for k in branches]
+        alts.extend('(?:{})'.format(t) for t in sorted(tails))
+        if len(alts) == 1:
+            parts.append(alts[0])
+        else:
+            parts.append('(?:{})'.format('|'.join(alts)))
+        return ''.join(parts)
+
+    return build(trie)
+
+
 class RegexFilter(object):
     """An object to be passed to TestProfile.filter.
 
@@ -74,6 +165,12 @@ class RegexFilter(object):
     a test that matches any regex will not be scheduled. Regardless of the
     value of the inverse flag if filters is empty then the test will be run.
 
+    Skip lists can have thousands of entries, so the filters are not searched
+    one by one. Filters of the form ^name$ are looked up in a set, and the
+    others are compiled into two regular expressions, one for the filters
+    anchored with ^ and one for the rest, in which the fixed strings the
+    filters start with are merged into a trie.
+
     Arguments:
     filters -- a list of regex compiled objects.
 
@@ -82,22 +179,56 @@ class RegexFilter(object):
     """
 
     def __init__(self, filters, inverse=False):
-        self.filters = [re.compile(f, flags=re.IGNORECASE) for f in filters]
+        filters = list(filters)
         self.inverse = inverse
+        self._empty = not filters
+        self._exact = set()
+        separate = []
+
+        entries = {True: [], False: []}
+        for f in filters:
+            start, prefix, tail = _split_filter(f)
+            if tail not in ('', '$'):
+                # Compiling it alone also catches filters like "a)|(b",
+                # which would be valid once wrapped in a group.
+                regex = re.compile(f, flags=re.IGNORECASE)
+                if _UNCOMBINABLE.search(tail):
+                    separate.append(regex)
+                    continue
+            if start and tail == '$' and all(ord(c) < 128 for c in prefix):
+                self._exact.add(prefix)
+            else:
+                entries[start].append((prefix, tail))
+
+        # Filters anchored at the start are kept apart from the others, so
+        # that they are only tried at the start of the name instead of at
+        # every position.
+        self._searches = []
+        for start, search in [(True, 'match'), (False, 'search')]:
+            if entries[start]:
+                regex = re.compile(_trie_regex(entries[start]),
+                                   flags=re.IGNORECASE)
+                self._searches.append(getattr(regex, search))
+        self._searches.extend(r.search for r in separate)
+
+    def _match(self, name):
+        if self._exact and name.lower() in self._exact:
+            return True
+        return any(search(name) for search in self._searches)
 
     def __call__(self, name, _):  # pylint: disable=invalid-name
         # This needs to match the signature (name, test), since it doesn't need
         # the test instance use _.
 
-        # If self.filters is empty then return True, we don't want to remove
+        # If there are no filters then return True, we don't want to remove
         # any tests from the run.
-        if not self.filters:
+        if self._empty:
             return True
 
         if not self.inverse:
-            return any(r.search(name) for r in self.filters)
+            return self._match(name)
         else:
-            return not any(r.search(name) for r in self.filters)
+            return not self._match(name)
 
 
 class TestDict(collections.abc.MutableMapping):
@@ -298,25 +429,19 @@ class Filters(collections.abc.MutableSequence):
                 yield k, v
 
 
-def make_test(element):
-    """Rebuild a test instance from xml."""
-    def process(elem, opt):
-        k = elem.attrib['name']
-        v = elem.attrib['value']
-        try:
-            opt[k] = ast.literal_eval(v)
-        except ValueError:
-            opt[k] = v
+def _literal(value):
+    try:
+        return ast.literal_eval(value)
+    except ValueError:
+        return value
 
-    type_ = element.attrib['type']
-    options = {}
-    for e in element.findall('./option'):
-        process(e, options)
-    options['env'] = {e.attrib['name']: e.attrib['value']
-                      for e in element.findall('./environment/env')}
 
+def _make_test(type_, options):
+    """Create a test instance of a serialized type from its arguments."""
     if type_ == 'gl':
         return PiglitGLTest(**options)
+    if type_ == 'gl_perf':
+        return PiglitPerfTest(**options)
     if type_ == 'gl_builtin':
         return BuiltInConstantsTest(**options)
     if type_ == 'cl':
@@ -332,11 +457,6 @@ def make_test(element):
     if type_ == 'vkrunner':
         return VkRunnerTest(**options)
     if type_ == 'multi_shader':
-        options['skips'] = []
-        for e in element.findall('./Skips/Skip/option'):
-            skips = {}
-            process(e, skips)
-            options['skips'].append(skips)
         return MultiShaderTest(**options)
     if type_ == 'xts':
         return XTSTest(**options)
@@ -345,6 +465,37 @@ def make_test(element):
     raise Exception('Unreachable')
 
 
+def make_test(element):
+    """Rebuild a test instance from xml."""
+    def process(elem, opt):
+        opt[elem.attrib['name']] = _literal(elem.attrib['value'])
+
+    type_ = element.attrib['type']
+    options = {}
+    for e in element.findall('./option'):
+        process(e, options)
+    options['env'] = {e.attrib['name']: e.attrib['value']
+                      for e in element.findall('./environment/env')}
+
+    if type_ == 'multi_shader':
+        options['skips'] = []
+        for e in element.findall('./Skips/Skip/option'):
+            skips = {}
+            process(e, skips)
+            options['skips'].append(skips)
+    return _make_test(type_, options)
+
+
+def make_test_from_record(record):
+    """Rebuild a test instance from an indexed profile record."""
+    options = {k: _literal(v) for k, v in record['options'].items()}
+    options['env'] = record.get('env', {})
+    if 'skips' in record:
+        options['skips'] = [{k: _literal(v) for k, v in s.items()}
+                            for s in record['skips']]
+    return _make_test(record['type'], options)
+
+
 class XMLProfile(object):
 
     def __init__(self, filename):
@@ -372,8 +523,11 @@ class XMLProfile(object):
     def teardown(self):
         pass
 
-    def _itertests(self):
-        """Always iterates tests instead of using the forced test_list."""
+    def _itertests(self, names=None):
+        """Always iterates tests instead of using the forced test_list.
+
+        If names is given only the tests in it are created.
+        """
         def _iter():
             with gzip.open(self.filename, 'rt') as f:
                 doc = et.iterparse(f, events=(b'end', ))
@@ -382,8 +536,8 @@ class XMLProfile(object):
                     if e.tag != 'Test':
                         continue
                     k = e.attrib['name']
-                    v = make_test(e)
-                    yield k, v
+                    if names is None or k in names:
+                        yield k, make_test(e)
                     root.clear()
 
         for k, v in self.filters.run(_iter()):
@@ -391,7 +545,7 @@ class XMLProfile(object):
 
     def itertests(self):
         if self.forced_test_list:
-            alltests = dict(self._itertests())
+            alltests = dict(self._itertests(set(self.forced_test_list)))
             opts = collections.OrderedDict()
             for n in self.forced_test_list:
                 if self.options['ignore_missing'] and n not in alltests:
@@ -403,6 +557,61 @@ class XMLProfile(object):
             return iter(self._itertests())
 
 
+class IndexedProfile(object):
+    """A profile in the indexed format written by tests/serializer.py.
+
+    Tests are read from the file when they are iterated, only the tests that
+    are iterated are ever in memory. The number of tests and the tests of a
+    forced test list are found without reading the whole file.
+    """
+
+    def __init__(self, filename):
+        self.filename = filename
+        self.forced_test_list = []
+        self.filters = Filters()
+        self.options = {
+            'dmesg': get_dmesg(False),
+            'monitor': Monitoring(False),
+            'ignore_missing': False,
+        }
+
+        with indexed_profile.Reader(filename) as reader:
+            self._count = len(reader)
+
+    def __len__(self):
+        if not (self.filters or self.forced_test_list):
+            return self._count
+        return sum(1 for _ in self.itertests())
+
+    def setup(self):
+        pass
+
+    def teardown(self):
+        pass
+
+    def _select(self, reader):
+        if not self.forced_test_list:
+            for record in reader:
+                yield record['name'], make_test_from_record(record)
+            return
+
+        for n in self.forced_test_list:
+            record = reader.get(n)
+            if record is not None:
+                yield n, make_test_from_record(record)
+            elif self.options['ignore_missing']:
+                yield n, DummyTest(n, status.NOTRUN)
+            else:
+                raise exceptions.PiglitFatalError(
+                    'Cannot find test "{}" in profile "{}"'.format(
+                        n, self.filename))
+
+    def itertests(self):
+        with indexed_profile.Reader(self.filename) as reader:
+            for k, v in self.filters.run(self._select(reader)):
+                yield k, v
+
+
 class MetaProfile(object):
 
     """Holds multiple profiles but acts like one.
@@ -579,6 +788,8 @@ def load_test_profile(filename, python=None):
         if os.path.isabs(filename):
             if '.meta' in filename:
                 return MetaProfile(filename)
+            if ext == indexed_profile.EXTENSION:
+                return IndexedProfile(filename)
             if '.xml' in filename:
                 return XMLProfile(filename)
 
@@ -586,6 +797,10 @@ def load_test_profile(filename, python=None):
         if os.path.exists(meta):
             return MetaProfile(meta)
 
+        indexed = os.path.join(ROOT_DIR, 'tests',
+                               name + indexed_profile.EXTENSION)
+        if os.path.exists(indexed):
+            return IndexedProfile(indexed)
 
         xml = os.path.join(ROOT_DIR, 'tests', name + '.xml.gz')
         if os.path.exists(xml):
@@ -593,7 +808,8 @@ def load_test_profile(filename, python=None):
 
     if python is False:
         raise exceptions.PiglitFatalError(
-            'Cannot open "tests/{0}.xml.gz" or "tests/{0}.meta.xml"'.format(name))
+            'Cannot open "tests/{0}.profile", "tests/{0}.xml.gz" or '
+            '"tests/{0}.meta.xml"'.format(name))
 
     try:
         mod = importlib.import_module('tests.{0}'.format(name))
@@ -619,8 +835,16 @@ def run(profiles, logger, backend, concurrency, jobs):
     pools.
 
     Based on the value of concurrency it will either run all the tests
-    concurrently, all serially, or first the thread safe tests then the
-    serial tests.
+    concurrently, all serially, or each test as soon as the resources it
+    needs are free, see framework/executor.py. The latter runs tests that
+    are not thread safe one at a time, but next to the thread safe ones.
+
+    If OPTIONS.processes is more than one, the tests run in that many forked
+    worker processes instead, see framework/process_executor.py.
+
+    If OPTIONS.schedule_from names a previous results file, the tests of all
+    profiles are started longest first, according to their durations in
+    that file, and the predicted and actual makespan are printed at the end.
 
     Finally it will print a final summary of the tests.
 
@@ -643,56 +867,125 @@ def run(profiles, logger, backend, concurrency, jobs):
         if profile.options['monitor'].abort_needed:
             this_pool.terminate()
 
-    def run_threads(pool, profile, test_list, filterby=None):
-        """ Open a pool, close it, and join it """
-        if filterby:
-            # Although filterby could be attached to TestProfile as a filter,
-            # it would have to be removed when run_threads exits, requiring
-            # more code, and adding side-effects
-            test_list = (x for x in test_list if filterby(x))
-
-        for n, t in test_list:
-            pool.apply_async(test, [n, t, profile, pool])
+    def submit(name, test_, profile):
+        """Hand a test to the pool that runs it."""
+        if concurrency == "some":
+            pool.apply_async(test, [name, test_, profile, pool],
+                             shared=test_.resources,
+                             exclusive=test_.exclusive_resources)
+        else:
+            pool.apply_async(test, [name, test_, profile, pool])
 
     def run_profile(profile, test_list):
         """Run an individual profile."""
         profile.setup()
-        if concurrency == "all":
-            run_threads(multi, profile, test_list)
-        elif concurrency == "none":
-            run_threads(single, profile, test_list)
-        else:
-            assert concurrency == "some"
-            # test_list is an iterator, we need to copy it to run it twice.
-            test_list = itertools.tee(test_list, 2)
-
-            # Filter and return only thread safe tests to the threaded pool
-            run_threads(multi, profile, test_list[0],
-                        lambda x: x[1].run_concurrent)
-
-            # Filter and return the non thread safe tests to the single
-            # pool
-            run_threads(single, profile, test_list[1],
-                        lambda x: not x[1].run_concurrent)
+        for n, t in test_list:
+            submit(n, t, profile)
         profile.teardown()
 
-    # Multiprocessing.dummy is a wrapper around Threading that provides a
-    # multiprocessing compatible API
-    #
-    # The default value of pool is the number of virtual processor cores
-    single = multiprocessing.dummy.Pool(1)
-    multi = multiprocessing.dummy.Pool(jobs)
+    def run_list(test_list):
+        """Run (name, test, profile) tuples of several profiles in order."""
+        for n, t, p in test_list:
+            submit(n, t, p)
+
+    def run_remote(name, test_, profile, log_):
+        """Run a test in a worker process of a ProcessExecutor."""
+        with backend.write_test(name) as w:
+            test_.execute(name, log_, profile.options)
+            w(test_.result)
+        if profile.options['monitor'].abort_needed:
+            return profile.options['monitor'].error_message
+        return None
+
+    def split_remote(test_list):
+        """Split tests into those for the worker processes, those that need
+        tokens exclusively and run here next to the workers, and those that
+        need the GPU for themselves and run after the workers are done.
+        """
+        remote, local, after = [], [], []
+        for n, t, p in test_list:
+            if concurrency == "all" or not t.exclusive_resources:
+                remote.append((n, t, p))
+            elif executor.GPU in t.exclusive_resources:
+                after.append((n, t, p))
+            else:
+                local.append((n, t, p))
+        return remote, local, after
+
+    def make_pool():
+        # Multiprocessing.dummy is a wrapper around Threading that provides a
+        # multiprocessing compatible API
+        #
+        # The default value of pool is the number of virtual processor cores
+        if concurrency == "all":
+            return multiprocessing.dummy.Pool(jobs)
+        elif concurrency == "none":
+            return multiprocessing.dummy.Pool(1)
+        assert concurrency == "some"
+        # Like the separate serial pool this replaces, tests that need a
+        # resource exclusively get a thread of their own on top of the jobs.
+        return executor.Executor(jobs or os.cpu_count() or 1, 1)
+
+    sched = None
+    if OPTIONS.schedule_from:
+        sched = schedule.load(OPTIONS.schedule_from)
+        scheduled = sched.order(
+            (n, t, p) for p, test_list in profiles for n, t in test_list)
+        predicted = sched.predict([(n, t) for n, t, _ in scheduled],
+                                  concurrency, jobs)
+    start = time.time()
+
+    processes = OPTIONS.processes if concurrency != "none" else 1
+    abort_message = None
 
     try:
-        for p in profiles:
-            run_profile(*p)
+        if processes > 1:
+            for p, _ in profiles:
+                p.setup()
+            if sched is None:
+                scheduled = [(n, t, p) for p, test_list in profiles
+                             for n, t in test_list]
+            remote, local, after = split_remote(scheduled)
+
+            # Fork the workers before this process starts any threads.
+            backend.share_with_processes()
+            workers = process_executor.ProcessExecutor(
+                remote, run_remote, log, processes,
+                max(1, (jobs or os.cpu_count() or 1) // processes))
+            # With concurrency "all" every test runs in the workers.
+            pool = make_pool() if local or after else None
+            run_list(local)
+            abort_message = workers.join()
+            if abort_message is None:
+                run_list(after)
+            for p, _ in profiles:
+                p.teardown()
+        elif sched is not None:
+            pool = make_pool()
+            for p, _ in profiles:
+                p.setup()
+            run_list(scheduled)
+            for p, _ in profiles:
+                p.teardown()
+        else:
+            pool = make_pool()
+            for p in profiles:
+                run_profile(*p)
 
-        for pool in [single, multi]:
+        if pool is not None:
             pool.close()
             pool.join()
     finally:
         log.get().summary()
 
+    if sched is not None:
+        print('Makespan: predicted {}, actual {}'.format(
+            datetime.timedelta(seconds=round(predicted)),
+            datetime.timedelta(seconds=round(time.time() - start))))
+
+    if abort_message is not None:
+        raise exceptions.PiglitAbort(abort_message)
+
     for p, _ in profiles:
         if p.options['monitor'].abort_needed:
             raise exceptions.PiglitAbort(p.options['monitor'].error_message)
@@ -34,8 +34,11 @@ from framework import dmesg
 from framework import exceptions
 from framework import monitoring
 from framework import profile
+from framework import wflinfo
+from framework import zygote
 from framework.results import TimeAttribute
 from framework.test import base
+from framework.test import piglit_test
 from . import parsers
 
 __all__ = ['run',
@@ -213,6 +216,17 @@ def _run_parser(input_):
                             'core', 'jobs', None),
                         help='Set the maximum number of jobs to run concurrently. '
                              'By default, the reported number of CPUs is used.')
+    parser.add_argument('--processes',
+                        dest='processes',
+                        action='store',
+                        type=int,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'core', 'processes', 1),
+                        metavar='<int>',
+                        help='Split the jobs between this many worker '
+                             'processes, for when a single piglit process '
+                             'cannot keep up with starting tests and '
+                             'collecting their results. Default: 1')
     parser.add_argument("--ignore-missing",
                         dest="ignore_missing",
                         action="store_true",
@@ -237,6 +251,66 @@ def _run_parser(input_):
     parser.add_argument("--glsl",
                         action="store_true",
                         help="Run shader runner tests with the -glsl (force GLSL) option")
+    parser.add_argument('--capabilities',
+                        dest='capabilities',
+                        type=path.realpath,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'core', 'capabilities', None),
+                        metavar='<file>',
+                        help='Cache the GL capabilities queried with wflinfo '
+                             'for fast skipping in this file, and reuse them '
+                             'if it already describes the same platform, '
+                             'renderer and driver. Default: '
+                             'capabilities.json in the results folder.')
+    parser.add_argument('--zygote',
+                        dest='zygote',
+                        action='store',
+                        type=booltype,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'core', 'zygote', 'false'),
+                        metavar='<bool>',
+                        help='Start tests by forking piglit-zygote, which '
+                             'has the GL libraries already loaded, instead '
+                             'of executing them. Requires a build with '
+                             'PIGLIT_BUILD_TEST_MODULES. This value can also '
+                             'be set in piglit.conf.')
+    parser.add_argument('--schedule-from',
+                        dest='schedule_from',
+                        type=path.realpath,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'core', 'schedule_from', None),
+                        metavar='<Results Path>',
+                        help='Start the tests longest first, according to '
+                             'their durations in this results file of a '
+                             'previous run, and print the predicted and '
+                             'actual duration of the run.')
+    parser.add_argument('--perf-baseline',
+                        dest='perf_baseline',
+                        type=path.realpath,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'perf', 'baseline', None),
+                        metavar='<Results Path>',
+                        help='Compare the measurements of performance tests '
+                             'against this results file. Regressions turn '
+                             'the test into a warn or fail.')
+    parser.add_argument('--perf-tolerance',
+                        dest='perf_tolerance',
+                        type=float,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'perf', 'tolerance', 0.05),
+                        metavar='<float>',
+                        help='Relative drop of a performance measurement '
+                             'compared to the baseline that is a warn. '
+                             'Default: 0.05')
+    parser.add_argument('--perf-fail-tolerance',
+                        dest='perf_fail_tolerance',
+                        type=float,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'perf', 'fail tolerance', 0.10),
+                        metavar='<float>',
+                        help='Relative drop of a performance measurement '
+                             'compared to the baseline that is a fail. '
+                             'Default: 0.10')
 
     return parser.parse_args(unparsed)
 
@@ -256,6 +330,7 @@ def _create_metadata(args, name, forced_test_list):
     opts['forced_test_list'] = forced_test_list
     opts['ignore_missing'] = args.ignore_missing
     opts['timeout'] = args.timeout
+    opts['backend'] = args.backend
 
     metadata = {'options': opts}
     metadata['name'] = name
@@ -317,6 +392,13 @@ def run(input_):
     options.OPTIONS.process_isolation = args.process_isolation
     options.OPTIONS.jobs = args.jobs
     options.OPTIONS.force_glsl = args.glsl
+    options.OPTIONS.perf_baseline = args.perf_baseline
+    options.OPTIONS.perf_tolerance = float(args.perf_tolerance)
+    options.OPTIONS.perf_fail_tolerance = float(args.perf_fail_tolerance)
+    options.OPTIONS.capabilities = args.capabilities
+    options.OPTIONS.zygote = args.zygote
+    options.OPTIONS.schedule_from = args.schedule_from
+    options.OPTIONS.processes = args.processes
 
     # Set the platform to pass to waffle
     options.OPTIONS.env['PIGLIT_PLATFORM'] = args.platform
@@ -385,7 +467,17 @@ def run(input_):
         if args.include_tests:
             p.filters.append(profile.RegexFilter(args.include_tests))
 
-    profile.run(profiles, args.log_level, backend, args.concurrency, args.jobs)
+    info = wflinfo.WflInfo()
+    info.load_snapshot(args.capabilities or
+                       path.join(args.results_path, 'capabilities.json'))
+    if options.OPTIONS.zygote:
+        zygote.start(piglit_test.TEST_BIN_DIR)
+    try:
+        profile.run(profiles, args.log_level, backend, args.concurrency,
+                    args.jobs)
+    finally:
+        info.write_snapshot()
+        zygote.stop()
 
     time_elapsed.end = time.time()
     backend.finalize({'time_elapsed': time_elapsed.to_json()})
@@ -432,6 +524,15 @@ def resume(input_):
     options.OPTIONS.jobs = args.jobs
     options.OPTIONS.no_retry = args.no_retry
     options.OPTIONS.force_glsl = results.options['force_glsl']
+    options.OPTIONS.perf_baseline = results.options.get('perf_baseline')
+    options.OPTIONS.perf_tolerance = results.options.get(
+        'perf_tolerance', options.OPTIONS.perf_tolerance)
+    options.OPTIONS.perf_fail_tolerance = results.options.get(
+        'perf_fail_tolerance', options.OPTIONS.perf_fail_tolerance)
+    options.OPTIONS.capabilities = results.options.get('capabilities')
+    options.OPTIONS.zygote = results.options.get('zygote', False)
+    options.OPTIONS.schedule_from = results.options.get('schedule_from')
+    options.OPTIONS.processes = results.options.get('processes', 1)
 
     core.get_config(args.config_file)
 
@@ -441,10 +542,12 @@ def resume(input_):
     results.options['env'] = core.collect_system_info()
     results.options['name'] = results.name
 
-    # Resume only works with the JSON backend
-    backend = backends.get_backend('json')(
-        args.results_path,
-        file_start_count=len(results.tests) + 1)
+    # The SQLite backend resumes in place, all other runs are resumed with
+    # the JSON backend
+    if results.options.get('backend') == 'sqlite':
+        backend = backends.get_backend('sqlite')(args.results_path)
+    else:
+        backend = backends.get_backend('json')(args.results_path)
     # Specifically do not initialize again, everything initialize does is done.
 
     # Don't re-run tests that have already completed, incomplete status tests
@@ -482,6 +585,13 @@ def resume(input_):
         if results.options['forced_test_list']:
             p.forced_test_list = results.options['forced_test_list']
 
+    info = wflinfo.WflInfo()
+    info.load_snapshot(options.OPTIONS.capabilities or
+                       path.join(args.results_path, 'capabilities.json'))
+
+    if options.OPTIONS.zygote:
+        zygote.start(piglit_test.TEST_BIN_DIR)
+
     # This is resumed, don't bother with time since it won't be accurate anyway
     try:
         profile.run(
@@ -493,6 +603,9 @@ def resume(input_):
     except exceptions.PiglitUserError as e:
         if str(e) != 'no matching tests':
             raise
+    finally:
+        info.write_snapshot()
+        zygote.stop()
 
     backend.finalize()
 
@@ -35,6 +35,7 @@ __all__ = [
     'console',
     'csv',
     'html',
+    'perf',
     'feature'
     'formatted'
 ]
@@ -281,7 +282,7 @@ def aggregate(input_):
         raise
 
     mode = backends.compression.get_mode() if use_compression else 'none'
-    comp_ext = '.{}'.format(mode) if mode != 'none' else ''
+    comp_ext = backends.compression.get_suffix(mode)
     print("Aggregated file written to: {}{}".format(outfile, comp_ext))
 
 
@@ -325,3 +326,36 @@ def feature(input_):
                 args.summaryDir))
 
     summary.feat(args.resultsFiles, args.summaryDir, args.featureFile)
+
+
+@exceptions.handler
+def perf(input_):
+    """Compare the performance measurements of two results files."""
+    unparsed = parsers.parse_config(input_)[1]
+
+    parser = argparse.ArgumentParser(parents=[parsers.CONFIG])
+    parser.add_argument("-r", "--regressions",
+                        action="store_true",
+                        help="Only display measurements that regressed.")
+    parser.add_argument('--tolerance',
+                        type=float,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'perf', 'tolerance', 0.05),
+                        metavar='<float>',
+                        help='Relative drop that is a warn. Default: 0.05')
+    parser.add_argument('--fail-tolerance',
+                        type=float,
+                        default=core.PIGLIT_CONFIG.safe_get(
+                            'perf', 'fail tolerance', 0.10),
+                        metavar='<float>',
+                        help='Relative drop that is a fail. Default: 0.10')
+    parser.add_argument("baseline",
+                        metavar="<Baseline Results Path>",
+                        help="Path to the results to compare against")
+    parser.add_argument("results",
+                        metavar="<Results Path>",
+                        help="Path to the results to compare")
+    args = parser.parse_args(unparsed)
+
+    summary.perf([args.baseline, args.results], float(args.tolerance),
+                 float(args.fail_tolerance), args.regressions)
@@ -144,7 +144,7 @@ class TestResult(object):
     """An object representing the result of a single test."""
     __slots__ = ['returncode', '_err', '_out', 'time', 'command', 'traceback',
                  'environment', 'subtests', 'dmesg', '__result', 'images',
-                 'exception', 'pid']
+                 'exception', 'pid', 'perf', 'rusage']
     err = StringDescriptor('_err')
     out = StringDescriptor('_out')
 
@@ -159,6 +159,8 @@ class TestResult(object):
         self.traceback = None
         self.exception = None
         self.pid = []
+        self.perf = {}
+        self.rusage = {}
         if result:
             self.result = result
         else:
@@ -208,6 +210,8 @@ class TestResult(object):
             'dmesg': self.dmesg,
             'images': self.images,
             'pid': self.pid,
+            'perf': self.perf,
+            'rusage': self.rusage,
         }
         return obj
 
@@ -227,7 +231,8 @@ class TestResult(object):
         inst = cls()
 
         for each in ['returncode', 'command', 'exception', 'environment',
-                     'traceback', 'dmesg', 'images', 'pid', 'result']:
+                     'traceback', 'dmesg', 'images', 'pid', 'perf', 'rusage',
+                     'result']:
             if each in dict_:
                 setattr(inst, each, dict_[each])
 
@@ -259,6 +264,12 @@ class TestResult(object):
                 self.images = dict_['images']
         elif 'subtest' in dict_:
             self.subtests.update(dict_['subtest'])
+        elif 'perf' in dict_:
+            self.perf.update(dict_['perf'])
+        elif 'rusage' in dict_:
+            # Tests report the usage so far with every result, the last one
+            # is the total.
+            self.rusage = dict_['rusage']
 
 
 class Totals(dict):
@@ -325,24 +336,36 @@ class TestrunResult(object):
     def calculate_group_totals(self):
         """Calculate the number of passes, fails, etc at each level."""
         for name, result in self.tests.items():
-            # If there are subtests treat the test as if it is a group instead
-            # of a test.
-            if result.subtests:
-                for res in result.subtests.values():
-                    res = str(res)
-                    temp = name
+            self.add_to_totals(name, result.result, result.subtests.values())
 
+    def add_to_totals(self, name, result, subtests):
+        """Count the status of a single test at each level.
+
+        Arguments:
+        name -- the name of the test
+        result -- the status of the test
+        subtests -- the statuses of the subtests of the test
+
+        """
+        subtests = list(subtests)
+        # If there are subtests treat the test as if it is a group instead
+        # of a test.
+        if subtests:
+            for res in subtests:
+                res = str(res)
+                temp = name
+
+                self.totals[temp][res] += 1
+                while temp:
+                    temp = grouptools.groupname(temp)
                     self.totals[temp][res] += 1
-                    while temp:
-                        temp = grouptools.groupname(temp)
-                        self.totals[temp][res] += 1
-                    self.totals['root'][res] += 1
-            else:
-                res = str(result.result)
-                while name:
-                    name = grouptools.groupname(name)
-                    self.totals[name][res] += 1
                 self.totals['root'][res] += 1
+        else:
+            res = str(result)
+            while name:
+                name = grouptools.groupname(name)
+                self.totals[name][res] += 1
+            self.totals['root'][res] += 1
 
     def to_json(self):
         if not self.totals:
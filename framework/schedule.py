@@ -0,0 +1,156 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+
+"""Module for ordering tests by their durations in a previous run.
+
+Tests are handed to the thread pools in profile order, so a few long tests
+that happen to come late stretch the end of the run while most threads are
+idle. Starting the longest tests first (longest processing time first, LPT)
+lets the short ones fill the gaps at the end instead.
+
+The durations are taken from any results file of a previous run of the same
+tests. Tests that are not in it are assumed to take the median duration.
+"""
+
+import heapq
+import itertools
+import os
+
+from framework import executor
+
+__all__ = [
+    'Schedule',
+    'load',
+    'makespan',
+    'token_makespan',
+]
+
+
+def makespan(durations, workers):
+    """Return the time it takes to run durations on workers.
+
+    Each duration is started, in order, on the first worker to become idle,
+    which is what a thread pool does with the jobs submitted to it.
+
+    """
+    finish = [0.0] * min(workers, len(durations))
+    for d in durations:
+        heapq.heapreplace(finish, finish[0] + d)
+    return max(finish, default=0.0)
+
+
+def token_makespan(jobs, workers, exclusive_workers=0):
+    """Return the time it takes to run jobs on an executor.Executor.
+
+    Arguments:
+    jobs -- a sequence of (duration, shared tokens, exclusive tokens)
+    workers -- the number of threads of the executor
+    exclusive_workers -- the number of threads only running jobs that need
+                         a token exclusively
+
+    """
+    queue = executor.TokenQueue()
+    for duration, shared, exclusive in jobs:
+        queue.push(duration, shared, exclusive)
+
+    now = 0.0
+    running = []
+    counter = itertools.count()
+    busy = {False: 0, True: 0}
+    limit = {False: workers, True: exclusive_workers}
+    while True:
+        # Jobs go to the general threads first, like when those are idle.
+        for exclusive_only in (False, True):
+            while busy[exclusive_only] < limit[exclusive_only]:
+                job = queue.pop(exclusive_only)
+                if job is None:
+                    break
+                duration, shared, exclusive = job
+                busy[exclusive_only] += 1
+                heapq.heappush(running, (now + duration, next(counter),
+                                         shared, exclusive, exclusive_only))
+        if not running:
+            return now
+        now, _, shared, exclusive, exclusive_only = heapq.heappop(running)
+        busy[exclusive_only] -= 1
+        queue.release(shared, exclusive)
+
+
+class Schedule(object):
+    """Estimated test durations and the order they imply.
+
+    Arguments:
+    durations -- a dict mapping test names to durations in seconds
+
+    """
+    def __init__(self, durations):
+        self.durations = durations
+        known = sorted(durations.values())
+        self.default = known[len(known) // 2] if known else 0.0
+
+    @classmethod
+    def from_results(cls, results):
+        """Create a Schedule from the test times of a TestrunResult."""
+        return cls({n: r.time.total for n, r in results.tests.items()
+                    if r.time.total > 0})
+
+    def estimate(self, name):
+        """Return the expected duration of a test in seconds."""
+        return self.durations.get(name, self.default)
+
+    def order(self, tests):
+        """Return tests, a sequence of tuples starting with the test name,
+        as a list with the longest tests first.
+
+        The sort is stable, tests with the same estimate keep their order.
+
+        """
+        return sorted(tests, key=lambda t: self.estimate(t[0]), reverse=True)
+
+    def predict(self, tests, concurrency, jobs=None):
+        """Return the expected makespan of running tests in order.
+
+        Arguments:
+        tests -- a sequence of (name, Test) tuples
+        concurrency -- 'all', 'some' or 'none', as passed to profile.run()
+        jobs -- the number of concurrent jobs, os.cpu_count() by default
+
+        With concurrency 'some' the tests wait for the resources they need,
+        like the executor running them, which has a thread for the tests
+        needing a resource exclusively on top of the jobs.
+
+        """
+        jobs = jobs or os.cpu_count() or 1
+        if concurrency == 'some':
+            return token_makespan(
+                [(self.estimate(n), t.resources, t.exclusive_resources)
+                 for n, t in tests], jobs, 1)
+
+        return makespan([self.estimate(n) for n, _ in tests],
+                        jobs if concurrency == 'all' else 1)
+
+
+def load(filename):
+    """Return a Schedule with the test durations of a results file."""
+    from framework import backends
+
+    return Schedule.from_results(backends.load(filename))
@@ -0,0 +1,79 @@
+# coding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Print a comparison of the performance measurements of two results."""
+
+from framework import grouptools, backends, status
+from framework.perf import Baseline
+
+__all__ = [
+    'perf',
+    'compare',
+]
+
+_HEADER = ('test', 'measurement', 'baseline', 'current', 'speedup',
+           'overlap', 'status')
+
+
+def compare(base, current, tolerance, fail_tolerance):
+    """Return a list of (test, Comparison) for two TestrunResults.
+
+    The list is sorted by speedup, so the largest regressions come first.
+
+    """
+    baseline = Baseline(base, tolerance, fail_tolerance)
+    comparisons = []
+    for name, result in current.tests.items():
+        if result.perf:
+            comparisons.extend((name, c)
+                               for c in baseline.compare(name, result))
+    return sorted(comparisons, key=lambda x: x[1].ratio)
+
+
+def perf(results_files, tolerance, fail_tolerance, regressions_only=False):
+    """Print a table comparing the measurements of two results files.
+
+    The first file is the baseline. Each measurement is printed with its
+    speedup, whether the confidence intervals of the two runs overlap, and
+    the status the regression gate would give it.
+
+    """
+    base, current = [backends.load(r) for r in results_files]
+
+    rows = []
+    for name, c in compare(base, current, tolerance, fail_tolerance):
+        if regressions_only and c.status == status.PASS:
+            continue
+        rows.append((grouptools.format(name), c.name,
+                     '{:.4g}'.format(c.base['rate']),
+                     '{:.4g}'.format(c.current['rate']),
+                     '{:.3f}x'.format(c.ratio),
+                     'yes' if c.overlap else 'no',
+                     str(c.status)))
+
+    widths = [max(len(r[i]) for r in [_HEADER] + rows)
+              for i in range(len(_HEADER))]
+    template = '  '.join('{:<%d}' % w for w in widths)
+
+    print(template.format(*_HEADER).rstrip())
+    print(template.format(*['-' * w for w in widths]).rstrip())
+    for row in rows:
+        print(template.format(*row).rstrip())
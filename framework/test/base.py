@@ -36,7 +36,9 @@ import traceback
 import warnings
 
 from framework import exceptions
+from framework import executor
 from framework import status
+from framework import zygote
 from framework.options import OPTIONS
 from framework.results import TestResult
 
@@ -64,6 +66,9 @@ __all__ = [
 # PIGLIT_NO_TIMEOUT to anything that bool() will resolve as True
 _SUPPRESS_TIMEOUT = bool(os.environ.get('PIGLIT_NO_TIMEOUT', False))
 
+# How long a timed out test gets to exit after SIGTERM before it is killed.
+_KILL_GRACE = 3
+
 
 class TestIsSkip(exceptions.PiglitException):
     """Exception raised in is_skip() if the test is a skip."""
@@ -120,6 +125,11 @@ class Test(metaclass=abc.ABCMeta):
     __slots__ = ['run_concurrent', 'env', 'result', 'cwd', '_command']
     timeout = None
 
+    # Tokens of the resources the test uses, which other tests can use at
+    # the same time unless one of them needs them exclusively. See
+    # framework/executor.py.
+    resources = frozenset()
+
     def __init__(self, command, run_concurrent=False, env=None, cwd=None):
         assert isinstance(command, list), command
 
@@ -129,6 +139,18 @@ class Test(metaclass=abc.ABCMeta):
         self.result = TestResult()
         self.cwd = cwd
 
+    @property
+    def exclusive_resources(self):
+        """Tokens of the resources no other test may use at the same time.
+
+        A test that doesn't run concurrently renders to the display, which
+        it needs for itself.
+
+        """
+        if self.run_concurrent:
+            return frozenset()
+        return frozenset([executor.DISPLAY])
+
     def execute(self, path, log, options):
         """ Run a test
 
@@ -271,13 +293,19 @@ class Test(metaclass=abc.ABCMeta):
         fullenv = {str(k): str(v) for k, v in _base}
 
         try:
-            proc = subprocess.Popen(command,
-                                    stdout=subprocess.PIPE,
-                                    stderr=subprocess.PIPE,
-                                    cwd=self.cwd,
-                                    env=fullenv,
-                                    universal_newlines=True,
-                                    **_EXTRA_POPEN_ARGS)
+            # The zygote starts tests it has a module for without exec, it
+            # returns None for everything else.
+            proc = None
+            if OPTIONS.zygote:
+                proc = zygote.spawn(command, self.cwd, fullenv)
+            if proc is None:
+                proc = subprocess.Popen(command,
+                                        stdout=subprocess.PIPE,
+                                        stderr=subprocess.PIPE,
+                                        cwd=self.cwd,
+                                        env=fullenv,
+                                        universal_newlines=True,
+                                        **_EXTRA_POPEN_ARGS)
 
             self.result.pid.append(proc.pid)
             if not _SUPPRESS_TIMEOUT:
@@ -300,19 +328,29 @@ class Test(metaclass=abc.ABCMeta):
 
             proc.terminate()
 
-            # XXX: This is probably broken on windows, since os.getpgid doesn't
-            # exist on windows. What is the right way to handle this?
-            if proc.poll() is None:
-                time.sleep(3)
-                os.killpg(os.getpgid(proc.pid), signal.SIGKILL)
-
-            # Since the process isn't running it's safe to get any remaining
-            # stdout/stderr values out and store them.
-            self.result.out, self.result.err = proc.communicate()
+            # Give the test a grace period to exit, but don't wait for it
+            # when it exits right away.
+            try:
+                out, err = proc.communicate(timeout=_KILL_GRACE)
+            except subprocess.TimeoutExpired:
+                # XXX: This is probably broken on windows, since os.getpgid
+                # doesn't exist on windows. What is the right way to handle
+                # this?
+                try:
+                    os.killpg(os.getpgid(proc.pid), signal.SIGKILL)
+                except ProcessLookupError:
+                    pass
+
+                # Since the process isn't running it's safe to get any
+                # remaining stdout/stderr values out.
+                out, err = proc.communicate()
 
+            # Test.run() replaces the output with the error message, keep
+            # what the test printed before it hung after it.
+            self.result.err = err
             raise TestRunError(
-                'Test run time exceeded timeout value ({} seconds)\n'.format(
-                    self.timeout),
+                'Test run time exceeded timeout value ({} seconds)\n{}'.format(
+                    self.timeout, out),
                 'timeout')
         # LLVM prints colored text into stdout/stderr on error, which raises:
         except UnicodeDecodeError as e:
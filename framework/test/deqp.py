@@ -23,7 +23,7 @@ import abc
 import os
 import subprocess
 
-from framework import core, grouptools, exceptions
+from framework import core, executor, grouptools, exceptions
 from framework import options
 from framework.profile import TestProfile
 from framework.test.base import Test, is_crash_returncode, TestRunError
@@ -126,6 +126,7 @@ class DEQPBaseTest(Test, metaclass=abc.ABCMeta):
         "NotSupported": "skip",
         "ResourceError": "crash",
     }
+    resources = frozenset([executor.GPU])
 
     @abc.abstractproperty
     def deqp_bin(self):
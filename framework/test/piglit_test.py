@@ -31,7 +31,7 @@ try:
 except ImportError:
     import json
 
-from framework import core, options
+from framework import core, executor, options, perf
 from framework import status
 from .base import Test, WindowResizeMixin, ValgrindMixin, TestIsSkip
 
@@ -40,6 +40,7 @@ __all__ = [
     'PiglitCLTest',
     'PiglitGLTest',
     'PiglitBaseTest',
+    'PiglitPerfTest',
     'PiglitReplayerTest',
     'VkRunnerTest',
     'CL_CONCURRENT',
@@ -126,6 +127,8 @@ class PiglitGLTest(WindowResizeMixin, PiglitBaseTest):
     options are mutually exclusive.
 
     """
+    resources = frozenset([executor.GPU])
+
     def __init__(self, command, require_platforms=None, exclude_platforms=None,
                  **kwargs):
         # TODO: There is a design flaw in python2, keyword args can be
@@ -186,6 +189,41 @@ class PiglitGLTest(WindowResizeMixin, PiglitBaseTest):
         self._command = [n for n in new if n not in ['-auto', '-fbo']]
 
 
+class PiglitPerfTest(PiglitGLTest):
+    """Test class for performance tests.
+
+    Performance tests report their measurements as 'perf' dictionaries, which
+    are compared against the baseline given with --perf-baseline, if any. A
+    measurement that regressed past the tolerance turns a pass into a warn
+    or a fail.
+
+    Perf tests never run concurrently, since other tests running on the same
+    GPU would make the measurements meaningless. With concurrency "some"
+    they wait for the GPU to be idle.
+
+    """
+    def __init__(self, command, **kwargs):
+        kwargs['run_concurrent'] = False
+        super(PiglitPerfTest, self).__init__(command, **kwargs)
+        self.name = None
+
+    @property
+    def exclusive_resources(self):
+        return frozenset([executor.GPU, executor.DISPLAY])
+
+    def execute(self, path, log, options):
+        # The baseline is looked up by the name of the test
+        self.name = path
+        super(PiglitPerfTest, self).execute(path, log, options)
+
+    def interpret_result(self):
+        super(PiglitPerfTest, self).interpret_result()
+
+        baseline = perf.get_baseline()
+        if baseline is not None and self.result.perf:
+            baseline.apply(self.name, self.result)
+
+
 class ASMParserTest(PiglitBaseTest):
 
     """Test class for ASM parser tests."""
@@ -239,6 +277,7 @@ class CLProgramTester(PiglitCLTest):
 
 class VkRunnerTest(PiglitBaseTest):
     """ Make a PiglitTest instance for a VkRunner shader test file """
+    resources = frozenset([executor.GPU])
 
     def __init__(self, filename, env=None):
         vkrunner_bin = core.get_option('PIGLIT_VKRUNNER_BINARY',
@@ -29,6 +29,7 @@ import os
 import re
 
 from framework import exceptions
+from framework import executor
 from framework import status
 from framework import options
 from .base import ReducedProcessMixin, TestIsSkip
@@ -151,6 +152,7 @@ class ShaderTest(FastSkipMixin, PiglitBaseTest):
     GLES3 test, and then returns a PiglitTest setup properly.
 
     """
+    resources = frozenset([executor.GPU])
 
     def __init__(self, command, api=None, extensions=set(),
                   shader_version=None, api_version=None, env=None, **kwargs):
@@ -209,6 +211,7 @@ class MultiShaderTest(ReducedProcessMixin, PiglitBaseTest):
     Arguments:
     filenames -- a list of absolute paths to shader test files
     """
+    resources = frozenset([executor.GPU])
 
     def __init__(self, prog, files, subtests, skips, env=None):
         super(MultiShaderTest, self).__init__(
@@ -20,6 +20,7 @@
 # SOFTWARE.
 
 import errno
+import json
 import os
 import subprocess
 import sys
@@ -31,6 +32,27 @@ from framework.options import OPTIONS
 # from framework.test import piglit_test
 
 
+# Bump when the format of the capability snapshot changes
+SNAPSHOT_VERSION = 1
+
+_CALL_LOCK = threading.Lock()
+
+
+def _driver_key(output):
+    """Return the renderer and version strings of a wflinfo output.
+
+    The version string contains the driver version for most implementations.
+
+    """
+    renderer = version = None
+    for line in output.split('\n'):
+        if line.startswith('OpenGL renderer string:'):
+            renderer = line.split(':', 1)[1].strip()
+        elif line.startswith('OpenGL version string:'):
+            version = line.split(':', 1)[1].strip()
+    return renderer, version
+
+
 class StopWflinfo(exceptions.PiglitException):
     """Exception called when wlfinfo getter should stop."""
     def __init__(self, reason):
@@ -82,7 +104,7 @@ class WflInfo(object):
         return self
 
     @staticmethod
-    def __call_wflinfo(opts):
+    def __run_wflinfo(opts):
         """Helper to call wflinfo and reduce code duplication.
 
         This catches and handles CalledProcessError and OSError.ernno == 2
@@ -128,6 +150,102 @@ class WflInfo(object):
                 raise
         return raw.decode('utf-8')
 
+    def __call_wflinfo(self, opts):
+        """Return the output of wflinfo for opts, calling it at most once.
+
+        Outputs are taken from the snapshot loaded by load_snapshot() once
+        the snapshot is known to describe the current driver, see
+        __check_snapshot(). A failed call is remembered as None.
+
+        """
+        key = ' '.join(opts)
+        with _CALL_LOCK:
+            outputs = self.__dict__.setdefault('_outputs', {})
+            if key not in outputs:
+                stored = self.__dict__.get('_stored', {})
+                if self.__dict__.get('_stored_valid') and key in stored:
+                    outputs[key] = stored[key]
+                else:
+                    try:
+                        outputs[key] = self.__run_wflinfo(opts)
+                    except StopWflinfo as e:
+                        if e.reason != 'Called':
+                            raise
+                        outputs[key] = None
+                    self.__check_snapshot(key, outputs[key])
+
+        if outputs[key] is None:
+            raise StopWflinfo('Called')
+        return outputs[key]
+
+    def __check_snapshot(self, key, output):
+        """Decide whether the loaded snapshot can be used.
+
+        The snapshot is used if the output of the first command actually run
+        reports the same renderer and driver as the snapshot did for that
+        command.
+
+        """
+        stored = self.__dict__.get('_stored')
+        if not stored or self.__dict__.get('_stored_valid') is not None:
+            return
+        if output is None or stored.get(key) is None:
+            return
+        self._stored_valid = _driver_key(output) == _driver_key(stored[key])
+
+    def load_snapshot(self, path):
+        """Load a capability snapshot written by write_snapshot().
+
+        The snapshot is ignored if it was written for a different platform,
+        or, on the first wflinfo call, if it turns out to describe a
+        different renderer or driver. In both cases write_snapshot()
+        replaces it.
+
+        """
+        self._snapshot_path = path
+        try:
+            with open(path, 'r') as f:
+                snapshot = json.load(f)
+        except (IOError, OSError, ValueError):
+            return
+
+        if (snapshot.get('version') != SNAPSHOT_VERSION or
+                snapshot.get('platform') != OPTIONS.env['PIGLIT_PLATFORM']):
+            return
+        self._stored = snapshot['outputs']
+        self._stored_valid = None
+
+    def write_snapshot(self):
+        """Write the wflinfo outputs of this run to the snapshot file.
+
+        Outputs of a still valid snapshot that this run didn't need are kept.
+
+        """
+        path = self.__dict__.get('_snapshot_path')
+        with _CALL_LOCK:
+            outputs = dict(self.__dict__.get('_outputs', {}))
+            if self.__dict__.get('_stored_valid') is not False:
+                for key, output in self.__dict__.get('_stored', {}).items():
+                    outputs.setdefault(key, output)
+
+        if path is None or not outputs:
+            return
+
+        renderer, driver = next(
+            (_driver_key(o) for o in outputs.values() if o is not None),
+            (None, None))
+        snapshot = {
+            'version': SNAPSHOT_VERSION,
+            'platform': OPTIONS.env['PIGLIT_PLATFORM'],
+            'renderer': renderer,
+            'driver': driver,
+            'outputs': outputs,
+        }
+        tmp = path + '.tmp'
+        with open(tmp, 'w') as f:
+            json.dump(snapshot, f, indent=4, sort_keys=True)
+        os.rename(tmp, path)
+
     @staticmethod
     def __getline(lines, name):
         """Find a line in a list return it."""
@@ -136,122 +254,88 @@ class WflInfo(object):
                 return line
         raise Exception('Unreachable')
 
-    def __get_shader_version(self, profile):
+    def __get_shader_version(self, profile, raw):
         """Calculate the maximum OpenGL Shader Language version."""
         ret = 0.0
         if profile in ['core', 'compat', 'none']:
             try:
-                raw = self.__call_wflinfo(
-                    ['--verbose', '--api', 'gl', '--profile', profile])
-            except StopWflinfo as e:
-                if e.reason not in ['Called', 'OSError']:
-                    raise
-            else:
-                try:
-                    # GLSL versions are M.mm formatted
-                    line = self.__getline(raw.split('\n'), 'OpenGL shading language')
-                    ret = float(line.split(":")[1][:5])
-                except (IndexError, ValueError):
-                    # This is caused by wflinfo returning an error
-                    pass
+                # GLSL versions are M.mm formatted
+                line = self.__getline(raw.split('\n'), 'OpenGL shading language')
+                ret = float(line.split(":")[1][:5])
+            except (IndexError, ValueError):
+                # This is caused by wflinfo returning an error
+                pass
         elif profile in ['gles2', 'gles3']:
             try:
-                raw = self.__call_wflinfo(['--verbose', '--api', profile])
-            except StopWflinfo as e:
-                if e.reason not in ['Called', 'OSError']:
-                    raise
-            else:
-                try:
-                    # GLSL ES version numbering is insane.
-                    # For version >= 3 the numbers are 3.00, 3.10, etc.
-                    # For version 2, they are 1.0.xx
-                    ret = float(self.__getline(
-                        raw.split('\n'),
-                        'OpenGL shading language').split()[-1][:3])
-                except (IndexError, ValueError):
-                    # Handle wflinfo internal errors
-                    pass
+                # GLSL ES version numbering is insane.
+                # For version >= 3 the numbers are 3.00, 3.10, etc.
+                # For version 2, they are 1.0.xx
+                ret = float(self.__getline(
+                    raw.split('\n'),
+                    'OpenGL shading language').split()[-1][:3])
+            except (IndexError, ValueError):
+                # Handle wflinfo internal errors
+                pass
         return ret
 
-    def __get_language_version(self, profile):
+    def __get_language_version(self, profile, raw):
         ret = 0.0
         if profile in ['core', 'compat', 'none']:
             try:
-                raw = self.__call_wflinfo(['--api', 'gl', '--profile', profile])
-            except StopWflinfo as e:
-                if e.reason not in ['Called', 'OSError']:
-                    raise
-            else:
-                try:
-                    # Grab the GL version string, trim any release_number values
-                    ret = float(self.__getline(
-                        raw.split('\n'),
-                        'OpenGL version string').split()[3][:3])
-                except (IndexError, ValueError):
-                    # This is caused by wlfinfo returning an error
-                    pass
+                # Grab the GL version string, trim any release_number values
+                ret = float(self.__getline(
+                    raw.split('\n'),
+                    'OpenGL version string').split()[3][:3])
+            except (IndexError, ValueError):
+                # This is caused by wlfinfo returning an error
+                pass
         else:
             try:
-                raw = self.__call_wflinfo(['--api', profile])
-            except StopWflinfo as e:
-                if e.reason not in ['Called', 'OSError']:
-                    raise
-            else:
-                try:
-                    # Yes, search for "OpenGL version string" in GLES
-                    # GLES doesn't support patch versions.
-                    ret = float(self.__getline(
-                        raw.split('\n'),
-                        'OpenGL version string').split()[5])
-                except (IndexError, ValueError):
-                    # This is caused by wlfinfo returning an error
-                    pass
+                # Yes, search for "OpenGL version string" in GLES
+                # GLES doesn't support patch versions.
+                ret = float(self.__getline(
+                    raw.split('\n'),
+                    'OpenGL version string').split()[5])
+            except (IndexError, ValueError):
+                # This is caused by wlfinfo returning an error
+                pass
         return ret
 
-    def __get_extensions(self, profile):
-        """Call wflinfo to get opengl extensions.
-
-        This provides a very conservative set of extensions, it provides every
-        extension from gles1, 2 and 3 and from GL both core and compat profile
-        as a single set. This may let a few tests execute that will still skip
-        manually, but it helps to ensure that this method never skips when it
-        shouldn't.
-
-        """
+    def __get_extensions(self, raw):
+        """Parse the opengl extensions out of the wflinfo output."""
         _trim = len('OpenGL extensions: ')
-        all_ = set()
-
-        def helper(args):
-            """Helper function to reduce code duplication."""
-            # This is a pretty fragile function but it really does help with
-            # duplication
-            ret = self.__call_wflinfo(args)
-            all_.update(set(self.__getline(
-                ret.split('\n'), 'OpenGL extensions')[_trim:].split()))
-
-        try:
-            if profile in ['core', 'compat', 'none']:
-                helper(['--verbose', '--api', 'gl', '--profile', profile])
-            else:
-                helper(['--verbose', '--api', profile])
-        except StopWflinfo as e:
-            # Handle wflinfo not being installed by returning an empty set. This
-            # will essentially make FastSkipMixin a no-op.
-            if e.reason in ['OSError', 'Called']:
-                return set()
-            raise
+        ret = {e.strip() for e in self.__getline(
+            raw.split('\n'), 'OpenGL extensions')[_trim:].split()}
 
         # Don't return a set with only WFLINFO_GL_ERROR.
-        ret = {e.strip() for e in all_}
         if ret == {'WFLINFO_GL_ERROR'}:
             return set()
         return ret
 
     def __build_info(self, profile):
+        """Build the ProfileInfo of a profile from a single wflinfo call.
+
+        If wflinfo isn't installed or can't create a context for the profile
+        the information is empty, which essentially makes FastSkipMixin a
+        no-op.
+
+        """
+        if profile in ['core', 'compat', 'none']:
+            opts = ['--verbose', '--api', 'gl', '--profile', profile]
+        else:
+            opts = ['--verbose', '--api', profile]
+
+        try:
+            raw = self.__call_wflinfo(opts)
+        except StopWflinfo as e:
+            if e.reason not in ['Called', 'OSError']:
+                raise
+            return ProfileInfo(0.0, 0.0, set())
+
         return ProfileInfo(
-            self.__get_shader_version(profile),
-            self.__get_language_version(profile),
-            self.__get_extensions(profile)
+            self.__get_shader_version(profile, raw),
+            self.__get_language_version(profile, raw),
+            self.__get_extensions(raw)
         )
 
     @lazy_property
@@ -0,0 +1,280 @@
+# coding=utf-8
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+"""Client of piglit-zygote, a fork server that starts tests without exec.
+
+piglit-zygote loads the piglit util library, libGL and the driver once, and
+runs each test by forking itself and calling main() of the shared module
+build of the test (see PIGLIT_BUILD_TEST_MODULES). That saves the dynamic
+linking and driver loading otherwise done by every single test process.
+
+Only tests from the piglit bin directory can be started this way, and only
+if a module was built for them. Everything else, and everything the zygote
+refuses, is left to subprocess.
+"""
+
+import array
+import locale
+import os
+import selectors
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import tempfile
+import threading
+import time
+
+from framework import exceptions
+
+__all__ = [
+    'Process',
+    'Server',
+    'spawn',
+    'start',
+    'stop',
+]
+
+# How long to wait for a new server to listen on its socket, in seconds
+_START_TIMEOUT = 10
+
+_SERVER = None
+_SERVER_LOCK = threading.Lock()
+
+
+def _decode(data):
+    """Decode output like subprocess.Popen with universal_newlines does."""
+    text = data.decode(locale.getpreferredencoding(False))
+    return text.replace('\r\n', '\n').replace('\r', '\n')
+
+
+class Process(object):
+    """A test started by piglit-zygote.
+
+    This implements the part of the subprocess.Popen interface that
+    Test._run_command uses: pid, returncode, poll(), communicate() and
+    terminate().
+
+    """
+    def __init__(self, sock, stdout, stderr, pid):
+        self.pid = pid
+        self.returncode = None
+        self._sock = sock
+        self._reply = b''
+        self._pipes = {stdout: [], stderr: []}
+        self._stdout = stdout
+        self._stderr = stderr
+
+    def _read_reply(self, data):
+        if not data:
+            # The handler died without telling how the test exited.
+            self.returncode = -signal.SIGKILL
+            return
+
+        self._reply += data
+        while b'\n' in self._reply and self.returncode is None:
+            line, self._reply = self._reply.split(b'\n', 1)
+            kind, value = line.decode().split()
+            if kind == 'exit':
+                self.returncode = int(value)
+            elif kind == 'signal':
+                self.returncode = -int(value)
+
+    def poll(self):
+        """Return the returncode if the test has exited, otherwise None."""
+        if self.returncode is None and self._sock is not None:
+            self._sock.setblocking(False)
+            try:
+                self._read_reply(self._sock.recv(256))
+            except BlockingIOError:
+                pass
+            finally:
+                self._sock.setblocking(True)
+        return self.returncode
+
+    def terminate(self):
+        """Send SIGTERM to the test."""
+        if self.returncode is None:
+            try:
+                os.kill(self.pid, signal.SIGTERM)
+            except ProcessLookupError:
+                pass
+
+    def communicate(self, timeout=None):
+        """Wait for the test to exit and return its (stdout, stderr).
+
+        Raises subprocess.TimeoutExpired if the test is still running after
+        timeout seconds. The output read so far is kept, so communicate can be
+        called again after killing the test.
+
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+
+        with selectors.DefaultSelector() as sel:
+            for fd in self._pipes:
+                if fd is not None:
+                    sel.register(fd, selectors.EVENT_READ)
+            if self.returncode is None:
+                sel.register(self._sock, selectors.EVENT_READ)
+
+            while sel.get_map():
+                remaining = None
+                if deadline is not None:
+                    remaining = deadline - time.monotonic()
+                    if remaining <= 0:
+                        raise subprocess.TimeoutExpired(None, timeout)
+
+                for key, _ in sel.select(remaining):
+                    if key.fileobj is self._sock:
+                        self._read_reply(self._sock.recv(256))
+                        if self.returncode is not None:
+                            sel.unregister(self._sock)
+                        continue
+
+                    data = os.read(key.fd, 65536)
+                    if data:
+                        self._pipes[key.fd].append(data)
+                    else:
+                        sel.unregister(key.fd)
+                        os.close(key.fd)
+
+        self._sock.close()
+        out = b''.join(self._pipes.pop(self._stdout))
+        err = b''.join(self._pipes.pop(self._stderr))
+        self._pipes[None] = []
+        self._stdout = self._stderr = None
+        return _decode(out), _decode(err)
+
+
+class Server(object):
+    """A running piglit-zygote.
+
+    Arguments:
+    bin_dir -- the directory containing piglit-zygote and the tests
+    module_dir -- the directory containing the test modules
+
+    """
+    def __init__(self, bin_dir, module_dir):
+        self.bin_dir = os.path.realpath(bin_dir)
+        self.module_dir = module_dir
+        self._tempdir = tempfile.mkdtemp(prefix='piglit-zygote-')
+        self._path = os.path.join(self._tempdir, 'socket')
+        self._proc = subprocess.Popen(
+            [os.path.join(bin_dir, 'piglit-zygote'), self._path, module_dir],
+            stdin=subprocess.DEVNULL)
+
+        deadline = time.monotonic() + _START_TIMEOUT
+        while not os.path.exists(self._path):
+            if (self._proc.poll() is not None or
+                    time.monotonic() > deadline):
+                self.stop()
+                raise exceptions.PiglitFatalError(
+                    'piglit-zygote failed to start')
+            time.sleep(0.01)
+
+    def stop(self):
+        """Stop the server. Tests that are still running are not killed."""
+        if self._proc.poll() is None:
+            self._proc.terminate()
+            self._proc.wait()
+        shutil.rmtree(self._tempdir, ignore_errors=True)
+
+    def spawn(self, command, cwd, env):
+        """Start a test, returning a Process, or None if the zygote can't."""
+        if os.path.dirname(os.path.realpath(command[0])) != self.bin_dir:
+            return None
+
+        payload = b''.join(
+            s.encode() + b'\0' for s in
+            [cwd or os.getcwd()] +
+            ['{}={}'.format(k, v) for k, v in env.items()] + [''] +
+            list(command) + [''])
+
+        out_r, out_w = os.pipe()
+        err_r, err_w = os.pipe()
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            sock.connect(self._path)
+            sock.sendmsg([struct.pack('=I', len(payload))],
+                         [(socket.SOL_SOCKET, socket.SCM_RIGHTS,
+                           array.array('i', [out_w, err_w]))])
+            sock.sendall(payload)
+
+            # Don't read past the first line, the rest belongs to Process.
+            reply = b''
+            while not reply.endswith(b'\n'):
+                data = sock.recv(1)
+                if not data:
+                    break
+                reply += data
+            reply = reply.decode().split(None, 1)
+        except OSError:
+            reply = []
+        finally:
+            os.close(out_w)
+            os.close(err_w)
+
+        if len(reply) != 2 or reply[0] != 'pid':
+            sock.close()
+            os.close(out_r)
+            os.close(err_r)
+            return None
+
+        return Process(sock, out_r, err_r, int(reply[1]))
+
+
+def start(bin_dir):
+    """Start the zygote for the tests in bin_dir."""
+    global _SERVER  # pylint: disable=global-statement
+
+    if not os.path.exists(os.path.join(bin_dir, 'piglit-zygote')):
+        raise exceptions.PiglitFatalError(
+            'piglit-zygote was not found in {}, it is built with '
+            'PIGLIT_BUILD_TEST_MODULES enabled'.format(bin_dir))
+
+    with _SERVER_LOCK:
+        if _SERVER is None:
+            _SERVER = Server(bin_dir,
+                             os.path.join(bin_dir, '..', 'lib', 'modules'))
+
+
+def stop():
+    """Stop the zygote, if it was started."""
+    global _SERVER  # pylint: disable=global-statement
+
+    with _SERVER_LOCK:
+        if _SERVER is not None:
+            _SERVER.stop()
+            _SERVER = None
+
+
+def spawn(command, cwd, env):
+    """Start a test through the zygote.
+
+    Returns a Process, or None if the zygote isn't running or can't start
+    this test, in which case the caller should start it itself.
+
+    """
+    server = _SERVER
+    if server is None:
+        return None
+    return server.spawn(command, cwd, env)
@@ -1006,6 +1006,9 @@ with profile.test_list.group_manager(
     g(['gl-get-active-attrib-returns-all-inputs'],
       'get-active-attrib-returns-all-inputs')
     g(['gl-3.2-texture-border-deprecated'], 'texture-border-deprecated')
+    g(['gl-3.2-threaded-buffer-map'], 'threaded-buffer-map')
+    g(['gl-3.2-threaded-shader-compile'], 'threaded-shader-compile')
+    g(['gl-3.2-threaded-texture-upload'], 'threaded-texture-upload')
 
 with profile.test_list.group_manager(
         PiglitGLTest,
@@ -26,6 +26,23 @@
 #include "piglit-util-gl.h"
 #include "common.h"
 
+/** Number of steady-state samples taken by perf_measure_rate_stats() */
+#define PERF_NUM_SAMPLES 4
+
+/**
+ * Number of timer queries in flight in perf_measure_timing(). The result
+ * of a query is only read back once this many batches were submitted after
+ * it, so the readback doesn't stall the GPU.
+ */
+#define PERF_QUERY_RING_SIZE 4
+
+struct perf_sample {
+	unsigned iters;
+	double wall;	/* seconds from the first submission to glFinish() */
+	double cpu;	/* seconds spent in the rate function */
+	double gpu;	/* seconds of GPU execution from TIME_ELAPSED queries */
+};
+
 /** Return time in seconds */
 static double
 perf_get_time(void)
@@ -35,10 +52,12 @@ perf_get_time(void)
 
 /**
  * Run function 'f' for enough iterations to reach a steady state.
- * Return the rate (iterations/second).
+ * Return the rate (iterations/second) and the number of iterations per
+ * sample needed to reach it.
  */
-double
-perf_measure_rate(perf_rate_func f, double minDuration)
+static double
+perf_find_steady_rate(perf_rate_func f, double minDuration,
+		      unsigned *subiters_out)
 {
 	double rate = 0.0, prevRate = 0.0;
 	unsigned subiters;
@@ -93,5 +112,220 @@ perf_measure_rate(perf_rate_func f, double minDuration)
 
 	if (0)
 		printf("%s returning iters %u  rate %f\n", __FUNCTION__, subiters, rate);
+	*subiters_out = subiters;
 	return rate;
 }
+
+/**
+ * Run function 'f' for enough iterations to reach a steady state.
+ * Return the rate (iterations/second).
+ */
+double
+perf_measure_rate(perf_rate_func f, double minDuration)
+{
+	unsigned subiters;
+
+	return perf_find_steady_rate(f, minDuration, &subiters);
+}
+
+/**
+ * Return the mean of PERF_NUM_SAMPLES samples, and their sample standard
+ * deviation in 'stddev'.
+ */
+static double
+perf_mean(const double *samples, double *stddev)
+{
+	double mean = 0.0, var = 0.0;
+	unsigned i;
+
+	for (i = 0; i < PERF_NUM_SAMPLES; i++)
+		mean += samples[i];
+	mean /= PERF_NUM_SAMPLES;
+
+	for (i = 0; i < PERF_NUM_SAMPLES; i++)
+		var += (samples[i] - mean) * (samples[i] - mean);
+	*stddev = sqrt(var / (PERF_NUM_SAMPLES - 1));
+
+	return mean;
+}
+
+/**
+ * Like perf_measure_rate(), but once the steady state is reached take a
+ * few more samples. Return their mean rate, and their standard deviation
+ * in 'stddev', so that the caller can tell noise from real changes.
+ */
+double
+perf_measure_rate_stats(perf_rate_func f, double minDuration, double *stddev)
+{
+	double samples[PERF_NUM_SAMPLES];
+	unsigned subiters, i;
+
+	perf_find_steady_rate(f, minDuration, &subiters);
+
+	for (i = 0; i < PERF_NUM_SAMPLES; i++) {
+		const double t0 = perf_get_time();
+		unsigned iters = 0;
+		double t1;
+
+		do {
+			f(subiters);
+			glFinish();
+			t1 = perf_get_time();
+			iters += subiters;
+		} while (t1 - t0 < minDuration);
+
+		samples[i] = iters / (t1 - t0);
+	}
+
+	return perf_mean(samples, stddev);
+}
+
+/**
+ * Whether GPU execution time can be measured, i.e. whether
+ * GL_ARB_timer_query is supported.
+ */
+bool
+perf_has_timer_query(void)
+{
+	static int supported = -1;
+
+	if (supported < 0)
+		supported = !piglit_is_gles() &&
+			    (piglit_get_gl_version() >= 33 ||
+			     piglit_is_extension_supported("GL_ARB_timer_query"));
+	return supported;
+}
+
+/**
+ * Submit batches of 'subiters' iterations for at least 'minDuration'
+ * seconds without waiting for the GPU in between, timing each batch on the
+ * CPU and, if supported, with a TIME_ELAPSED query on the GPU.
+ */
+static void
+perf_timed_sample(perf_rate_func f, unsigned subiters, double minDuration,
+		  struct perf_sample *sample)
+{
+	const bool gpu = perf_has_timer_query();
+	GLuint queries[PERF_QUERY_RING_SIZE];
+	unsigned issued = 0, retired = 0;
+	GLuint64 elapsed;
+	double t0, t1;
+
+	memset(sample, 0, sizeof(*sample));
+	if (gpu)
+		glGenQueries(PERF_QUERY_RING_SIZE, queries);
+
+	t0 = perf_get_time();
+	do {
+		double c0;
+
+		if (gpu) {
+			/* Reuse the oldest query once the ring is full. */
+			if (issued - retired == PERF_QUERY_RING_SIZE) {
+				glGetQueryObjectui64v(
+					queries[retired % PERF_QUERY_RING_SIZE],
+					GL_QUERY_RESULT, &elapsed);
+				sample->gpu += elapsed * 0.000000001;
+				retired++;
+			}
+			glBeginQuery(GL_TIME_ELAPSED,
+				     queries[issued % PERF_QUERY_RING_SIZE]);
+		}
+
+		c0 = perf_get_time();
+		f(subiters);
+		t1 = perf_get_time();
+		sample->cpu += t1 - c0;
+		sample->iters += subiters;
+
+		if (gpu) {
+			glEndQuery(GL_TIME_ELAPSED);
+			issued++;
+		}
+	} while (t1 - t0 < minDuration);
+
+	glFinish();
+	sample->wall = perf_get_time() - t0;
+
+	for (; retired < issued; retired++) {
+		glGetQueryObjectui64v(queries[retired % PERF_QUERY_RING_SIZE],
+				      GL_QUERY_RESULT, &elapsed);
+		sample->gpu += elapsed * 0.000000001;
+	}
+
+	if (gpu)
+		glDeleteQueries(PERF_QUERY_RING_SIZE, queries);
+}
+
+/**
+ * Like perf_measure_rate_stats(), but measure the wall clock rate, the
+ * rate of CPU submission and the rate of GPU execution separately. Batches
+ * are pipelined instead of waiting for each one with glFinish().
+ *
+ * The GPU rate is 0 if timer queries aren't supported.
+ */
+void
+perf_measure_timing(perf_rate_func f, double minDuration,
+		    struct perf_timing *timing)
+{
+	double wall[PERF_NUM_SAMPLES], cpu[PERF_NUM_SAMPLES];
+	double gpu[PERF_NUM_SAMPLES];
+	struct perf_sample sample;
+	unsigned subiters, i;
+
+	perf_find_steady_rate(f, minDuration, &subiters);
+
+	for (i = 0; i < PERF_NUM_SAMPLES; i++) {
+		perf_timed_sample(f, subiters, minDuration, &sample);
+		wall[i] = sample.iters / sample.wall;
+		cpu[i] = sample.iters / sample.cpu;
+		gpu[i] = sample.gpu > 0 ? sample.iters / sample.gpu : 0;
+	}
+
+	timing->rate = perf_mean(wall, &timing->rate_stddev);
+	timing->cpu_rate = perf_mean(cpu, &timing->cpu_rate_stddev);
+	timing->gpu_rate = perf_mean(gpu, &timing->gpu_rate_stddev);
+}
+
+/**
+ * Report a named measurement to the piglit framework when running in
+ * automatic mode. Higher rates are better. The framework compares the rate
+ * against a baseline to detect regressions.
+ */
+void
+perf_report_rate(const char *name, double rate, double stddev)
+{
+	if (!piglit_automatic)
+		return;
+
+	printf("PIGLIT: {\"perf\": {\"%s\": {\"rate\": %.17g, "
+	       "\"stddev\": %.17g}}}\n", name, rate, stddev);
+	fflush(stdout);
+}
+
+/**
+ * Report the rates measured by perf_measure_timing(), multiplied by
+ * 'scale', as the measurements "<name>, wall", "<name>, cpu" and
+ * "<name>, gpu". The pipelined wall clock rate is not comparable with the
+ * rate of perf_measure_rate_stats(), so it isn't reported as "<name>".
+ */
+void
+perf_report_timing(const char *name, const struct perf_timing *timing,
+		   double scale)
+{
+	char buf[256];
+
+	snprintf(buf, sizeof(buf), "%s, wall", name);
+	perf_report_rate(buf, timing->rate * scale,
+			 timing->rate_stddev * scale);
+
+	snprintf(buf, sizeof(buf), "%s, cpu", name);
+	perf_report_rate(buf, timing->cpu_rate * scale,
+			 timing->cpu_rate_stddev * scale);
+
+	if (timing->gpu_rate > 0) {
+		snprintf(buf, sizeof(buf), "%s, gpu", name);
+		perf_report_rate(buf, timing->gpu_rate * scale,
+				 timing->gpu_rate_stddev * scale);
+	}
+}
@@ -22,10 +22,36 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <stdbool.h>
+
 typedef void (*perf_rate_func)(unsigned count);
 
+/** Rates (iterations/second) measured by perf_measure_timing() */
+struct perf_timing {
+	double rate, rate_stddev;		/* wall clock */
+	double cpu_rate, cpu_rate_stddev;	/* CPU submission */
+	double gpu_rate, gpu_rate_stddev;	/* GPU execution */
+};
+
 double
 perf_measure_rate(perf_rate_func f, double minDuration);
 
+double
+perf_measure_rate_stats(perf_rate_func f, double minDuration, double *stddev);
+
+void
+perf_report_rate(const char *name, double rate, double stddev);
+
+bool
+perf_has_timer_query(void);
+
+void
+perf_measure_timing(perf_rate_func f, double minDuration,
+		    struct perf_timing *timing);
+
+void
+perf_report_timing(const char *name, const struct perf_timing *timing,
+		   double scale);
+
 #endif /* COMMON_H */
 
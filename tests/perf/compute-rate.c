@@ -0,0 +1,347 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Measure compute shader throughput.
+ *
+ * - dispatch overhead (tiny dispatches per second)
+ * - SSBO read, write and copy bandwidth
+ * - shared memory bandwidth
+ * - atomic throughput, contended and uncontended
+ * - fp32, fp64 and int64 ALU throughput
+ *
+ * Everything except the dispatch overhead is measured for a range of
+ * local work group sizes.
+ *
+ * Options:
+ * -gpu-time measure GPU execution time with timer queries, and report it
+ *           separately from CPU submission time
+ */
+
+#include "common.h"
+#include <stdbool.h>
+#undef NDEBUG
+#include <assert.h>
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_core_version = 43;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+/* Invocations per dispatch, and the number of elements in each buffer. */
+#define NUM_INVOCATIONS (1024 * 1024)
+
+/* Unrolled operations per invocation in the ALU and shared memory tests. */
+#define NUM_OPS 64
+
+enum cs_test {
+	CS_SSBO_READ,
+	CS_SSBO_WRITE,
+	CS_SSBO_COPY,
+	CS_SHARED,
+	CS_ATOMIC_SAME,
+	CS_ATOMIC_UNIQUE,
+	CS_ALU_FP32,
+	CS_ALU_FP64,
+	CS_ALU_INT64,
+	NUM_CS_TESTS,
+};
+
+static const struct {
+	const char *name;
+	const char *unit;
+	/* Bytes or operations per invocation. */
+	double amount;
+} tests[] = {
+	[CS_SSBO_READ]		= {"SSBO read",		"GB/s",		16},
+	[CS_SSBO_WRITE]		= {"SSBO write",	"GB/s",		16},
+	[CS_SSBO_COPY]		= {"SSBO copy",		"GB/s",		32},
+	[CS_SHARED]		= {"shared memory",	"GB/s",		NUM_OPS * 32},
+	[CS_ATOMIC_SAME]	= {"atomics, same address", "Gatomics/s", 1},
+	[CS_ATOMIC_UNIQUE]	= {"atomics, unique address", "Gatomics/s", 1},
+	[CS_ALU_FP32]		= {"fp32 MAD",		"GMADs/s",	NUM_OPS},
+	[CS_ALU_FP64]		= {"fp64 MAD",		"GMADs/s",	NUM_OPS},
+	[CS_ALU_INT64]		= {"int64 MAD",		"GMADs/s",	NUM_OPS},
+};
+
+static const unsigned local_sizes[] = {32, 64, 128, 256, 512, 1024};
+
+static GLint max_invocations;
+static bool has_int64;
+static unsigned num_groups;
+static bool gpu_time;
+
+void
+piglit_init(int argc, char **argv)
+{
+	GLuint bufs[3];
+	void *zeros;
+
+	for (unsigned i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-gpu-time") == 0)
+			gpu_time = true;
+	}
+
+	piglit_require_gl_version(43);
+
+	has_int64 = piglit_is_extension_supported("GL_ARB_gpu_shader_int64");
+	glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_invocations);
+
+	/* 0 = vec4 source, 1 = vec4 destination, 2 = uint counters
+	 *
+	 * Zero them, so that the branch of the read test is never taken
+	 * instead of depending on undefined contents.
+	 */
+	zeros = calloc(NUM_INVOCATIONS, 16);
+	glGenBuffers(3, bufs);
+	for (unsigned i = 0; i < 3; i++) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufs[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, NUM_INVOCATIONS * 16,
+			     zeros, GL_STATIC_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, bufs[i]);
+	}
+	free(zeros);
+}
+
+static void
+get_alu_text(char *s, const char *type)
+{
+	unsigned i;
+
+	sprintf(s + strlen(s),
+		"layout(std430, binding = 1) buffer dst_buf { %s dst[]; };\n"
+		"void main() {\n"
+		"	%s x = %s(gl_GlobalInvocationID.x);\n"
+		"	%s y = x + %s(1);\n",
+		type, type, type, type, type);
+	/* Dependent MADs, so that nothing can be folded away. */
+	for (i = 0; i < NUM_OPS; i++)
+		sprintf(s + strlen(s), "	x = x * y + %s(3);\n", type);
+	/* Never true in practice, but keeps the result alive. */
+	sprintf(s + strlen(s),
+		"	if (x == %s(1))\n"
+		"		dst[gl_GlobalInvocationID.x] = x;\n"
+		"}\n", type);
+}
+
+static void
+get_cs_text(char *s, enum cs_test test, unsigned local_size)
+{
+	sprintf(s, "#version 430\n");
+	if (test == CS_ALU_INT64)
+		strcat(s, "#extension GL_ARB_gpu_shader_int64 : require\n");
+	sprintf(s + strlen(s),
+		"layout(local_size_x = %u) in;\n", local_size);
+
+	switch (test) {
+	case CS_SSBO_READ:
+		strcat(s,
+		       "layout(std430, binding = 0) buffer src_buf { vec4 src[]; };\n"
+		       "layout(std430, binding = 1) buffer dst_buf { vec4 dst[]; };\n"
+		       "void main() {\n"
+		       "	vec4 v = src[gl_GlobalInvocationID.x];\n"
+		       "	if (v.x == -1.0)\n"
+		       "		dst[gl_GlobalInvocationID.x] = v;\n"
+		       "}\n");
+		break;
+	case CS_SSBO_WRITE:
+		strcat(s,
+		       "layout(std430, binding = 1) buffer dst_buf { vec4 dst[]; };\n"
+		       "void main() {\n"
+		       "	dst[gl_GlobalInvocationID.x] = vec4(gl_GlobalInvocationID.x);\n"
+		       "}\n");
+		break;
+	case CS_SSBO_COPY:
+		strcat(s,
+		       "layout(std430, binding = 0) buffer src_buf { vec4 src[]; };\n"
+		       "layout(std430, binding = 1) buffer dst_buf { vec4 dst[]; };\n"
+		       "void main() {\n"
+		       "	dst[gl_GlobalInvocationID.x] = src[gl_GlobalInvocationID.x];\n"
+		       "}\n");
+		break;
+	case CS_SHARED:
+		sprintf(s + strlen(s),
+			"layout(std430, binding = 1) buffer dst_buf { vec4 dst[]; };\n"
+			"shared vec4 sh[%u];\n"
+			"void main() {\n"
+			"	uint l = gl_LocalInvocationIndex;\n"
+			"	vec4 v = vec4(l);\n"
+			"	for (int i = 0; i < %u; i++) {\n"
+			"		sh[l] = v;\n"
+			"		barrier();\n"
+			"		v += sh[(l + 1u) %% %uu];\n"
+			"		barrier();\n"
+			"	}\n"
+			"	if (v.x == -1.0)\n"
+			"		dst[gl_GlobalInvocationID.x] = v;\n"
+			"}\n", local_size, NUM_OPS, local_size);
+		break;
+	case CS_ATOMIC_SAME:
+		strcat(s,
+		       "layout(std430, binding = 2) buffer counter_buf { uint counters[]; };\n"
+		       "void main() {\n"
+		       "	atomicAdd(counters[0], 1u);\n"
+		       "}\n");
+		break;
+	case CS_ATOMIC_UNIQUE:
+		strcat(s,
+		       "layout(std430, binding = 2) buffer counter_buf { uint counters[]; };\n"
+		       "void main() {\n"
+		       "	atomicAdd(counters[gl_GlobalInvocationID.x], 1u);\n"
+		       "}\n");
+		break;
+	case CS_ALU_FP32:
+		get_alu_text(s, "float");
+		break;
+	case CS_ALU_FP64:
+		get_alu_text(s, "double");
+		break;
+	case CS_ALU_INT64:
+		get_alu_text(s, "int64_t");
+		break;
+	default:
+		assert(!"wrong compute test");
+	}
+}
+
+static void
+dispatch(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++)
+		glDispatchCompute(num_groups, 1, 1);
+}
+
+static void
+dispatch_barrier(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		glDispatchCompute(num_groups, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+/**
+ * Return the throughput in bytes or operations per second, or 0 if the
+ * test can't run with this local size.
+ */
+static double
+run_test(enum cs_test test, unsigned local_size)
+{
+	const double scale = (double)NUM_INVOCATIONS * tests[test].amount;
+	char cs[8192], name[64];
+	GLuint prog;
+	double rate;
+
+	if (local_size > max_invocations)
+		return 0;
+	if (test == CS_ALU_INT64 && !has_int64)
+		return 0;
+
+	get_cs_text(cs, test, local_size);
+	prog = piglit_build_simple_program_multiple_shaders(
+			GL_COMPUTE_SHADER, cs, 0);
+	glUseProgram(prog);
+
+	num_groups = NUM_INVOCATIONS / local_size;
+	snprintf(name, sizeof(name), "%s, local size %u", tests[test].name,
+		 local_size);
+
+	if (gpu_time) {
+		struct perf_timing timing;
+
+		perf_measure_timing(dispatch, 0.15, &timing);
+		perf_report_timing(name, &timing, scale);
+		rate = (timing.gpu_rate ? timing.gpu_rate : timing.rate) * scale;
+	} else {
+		double stddev;
+
+		rate = perf_measure_rate_stats(dispatch, 0.15, &stddev) * scale;
+		perf_report_rate(name, rate, stddev * scale);
+	}
+
+	glUseProgram(0);
+	glDeleteProgram(prog);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+	return rate;
+}
+
+static void
+run_dispatch_overhead(void)
+{
+	char cs[1024];
+	double rate, stddev;
+	GLuint prog;
+
+	get_cs_text(cs, CS_SSBO_WRITE, 1);
+	prog = piglit_build_simple_program_multiple_shaders(
+			GL_COMPUTE_SHADER, cs, 0);
+	glUseProgram(prog);
+	num_groups = 1;
+
+	rate = perf_measure_rate_stats(dispatch, 0.5, &stddev);
+	perf_report_rate("dispatch", rate, stddev);
+	printf("  %-25s, %8u\n", "Dispatch overhead (K/s)",
+	       (unsigned)(rate / 1000));
+
+	rate = perf_measure_rate_stats(dispatch_barrier, 0.5, &stddev);
+	perf_report_rate("dispatch with memory barrier", rate, stddev);
+	printf("  %-25s, %8u\n", "  with memory barrier",
+	       (unsigned)(rate / 1000));
+
+	glUseProgram(0);
+	glDeleteProgram(prog);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	run_dispatch_overhead();
+
+	printf("  %-25s, %-10s", "Test", "Unit");
+	for (unsigned i = 0; i < ARRAY_SIZE(local_sizes); i++)
+		printf(", %6u", local_sizes[i]);
+	printf("\n");
+
+	for (unsigned test = 0; test < NUM_CS_TESTS; test++) {
+		printf("  %-25s, %-10s", tests[test].name, tests[test].unit);
+		fflush(stdout);
+
+		for (unsigned i = 0; i < ARRAY_SIZE(local_sizes); i++) {
+			double rate = run_test(test, local_sizes[i]);
+
+			if (rate == 0)
+				printf(",    n/a");
+			else
+				printf(", %6.2f", rate / 1000000000);
+			fflush(stdout);
+		}
+		printf("\n");
+	}
+
+	piglit_report_result(PIGLIT_PASS);
+	return PIGLIT_PASS;
+}
@@ -0,0 +1,455 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Measure fill rate and fragment throughput under various circumstances.
+ *
+ * All rendering goes to offscreen framebuffer objects, so the window is
+ * never used and the test behaves the same with -fbo.
+ *
+ * Variables:
+ * - render target format
+ * - MSAA sample count
+ * - blending
+ * - depth test mode (none, always, pass, reject)
+ * - fragment shader ALU load
+ * - fragment shader texture load
+ *
+ * Options:
+ * -size=N   width and height of the render target (default 1024)
+ * -freq=N   GPU frequency in MHz, report pixels/clock instead of Gpixels/s
+ * -gpu-time measure GPU execution time with timer queries, and report it
+ *           separately from CPU submission time
+ */
+
+#include "common.h"
+#include <stdbool.h>
+#undef NDEBUG
+#include <assert.h>
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_compat_version = 30;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define MAX_TEXTURES 8
+
+static unsigned gpu_freq_mhz;
+static bool gpu_time;
+static unsigned fb_size = 1024;
+static GLint max_samples;
+static GLuint vbo, tex[MAX_TEXTURES];
+
+static const struct {
+	GLenum format;
+	const char *name;
+} formats[] = {
+	{GL_RGBA8,		"RGBA8"},
+	{GL_RGB10_A2,		"RGB10_A2"},
+	{GL_R11F_G11F_B10F,	"R11G11B10F"},
+	{GL_RGBA16F,		"RGBA16F"},
+	{GL_RGBA32F,		"RGBA32F"},
+};
+
+static const unsigned sample_counts[] = {0, 2, 4, 8};
+
+enum depth_mode {
+	DEPTH_NONE,
+	DEPTH_ALWAYS,
+	DEPTH_PASS,
+	DEPTH_REJECT,
+	NUM_DEPTH_MODES,
+};
+
+static const char *depth_mode_names[] = {
+	"no depth",
+	"depth always",
+	"depth pass",
+	"depth reject",
+};
+
+void
+piglit_init(int argc, char **argv)
+{
+	static const float verts[4][4] = {
+		{-1, -1, 0, 1},
+		{ 1, -1, 0, 1},
+		{-1,  1, 0, 1},
+		{ 1,  1, 0, 1},
+	};
+	GLuint vao;
+
+	for (unsigned i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "-freq=", 6) == 0)
+			sscanf(argv[i] + 6, "%u", &gpu_freq_mhz);
+		else if (strncmp(argv[i], "-size=", 6) == 0)
+			sscanf(argv[i] + 6, "%u", &fb_size);
+		else if (strcmp(argv[i], "-gpu-time") == 0)
+			gpu_time = true;
+	}
+
+	piglit_require_gl_version(30);
+
+	glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	glVertexAttribPointer(PIGLIT_ATTRIB_POS, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+	glEnableVertexAttribArray(PIGLIT_ATTRIB_POS);
+
+	/* Textures are sampled 1:1 with the render target, which is the
+	 * common case for post-processing passes.
+	 */
+	for (unsigned i = 0; i < MAX_TEXTURES; i++) {
+		glActiveTexture(GL_TEXTURE0 + i);
+		tex[i] = piglit_rgbw_texture(GL_RGBA8, fb_size, fb_size,
+					     false, true, GL_UNSIGNED_BYTE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+				GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+				GL_LINEAR);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+static void
+get_fs_text(char *s, unsigned num_alu, unsigned num_textures)
+{
+	unsigned i;
+
+	strcpy(s, "#version 130\n"
+		  "uniform vec4 u;\n"
+		  "in vec2 tc;\n");
+	for (i = 0; i < num_textures; i++)
+		sprintf(s + strlen(s), "uniform sampler2D s%u;\n", i);
+	strcat(s, "void main() {\n"
+		  "	vec4 c = u;\n");
+	/* Dependent MADs, so that nothing can be folded away. */
+	for (i = 0; i < num_alu; i++)
+		strcat(s, "	c = c * u + vec4(0.25);\n");
+	for (i = 0; i < num_textures; i++)
+		sprintf(s + strlen(s), "	c += texture(s%u, tc);\n", i);
+	strcat(s, "	gl_FragColor = c;\n"
+		  "}\n");
+}
+
+static GLuint
+setup_program(unsigned num_alu, unsigned num_textures)
+{
+	static const char *vs =
+		"#version 130\n"
+		"in vec4 piglit_vertex;\n"
+		"out vec2 tc;\n"
+		"void main() {\n"
+		"	gl_Position = piglit_vertex;\n"
+		"	tc = piglit_vertex.xy * 0.5 + 0.5;\n"
+		"}\n";
+	char fs[4096];
+	GLuint prog;
+
+	assert(num_alu <= 64);
+	assert(num_textures <= MAX_TEXTURES);
+
+	get_fs_text(fs, num_alu, num_textures);
+	prog = piglit_build_simple_program(vs, fs);
+	glUseProgram(prog);
+
+	/* Keep the output in [0, 1] so that no format clamps differently. */
+	glUniform4f(glGetUniformLocation(prog, "u"), 0.5, 0.25, 0.125, 0.5);
+	for (unsigned i = 0; i < num_textures; i++) {
+		char sampler[20];
+		int loc;
+
+		snprintf(sampler, sizeof(sampler), "s%u", i);
+		loc = glGetUniformLocation(prog, sampler);
+		assert(loc >= 0);
+		glUniform1i(loc, i);
+	}
+	return prog;
+}
+
+/**
+ * Create a framebuffer with the given color format, sample count and an
+ * optional depth buffer. Return 0 if the combination is unsupported.
+ */
+static GLuint
+create_fbo(GLenum format, unsigned samples, bool depth, GLuint rb[2])
+{
+	GLuint fbo;
+
+	rb[0] = rb[1] = 0;
+	if (samples > max_samples)
+		return 0;
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	glGenRenderbuffers(1, &rb[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, rb[0]);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format,
+					 fb_size, fb_size);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+				  GL_RENDERBUFFER, rb[0]);
+
+	if (depth) {
+		glGenRenderbuffers(1, &rb[1]);
+		glBindRenderbuffer(GL_RENDERBUFFER, rb[1]);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples,
+						 GL_DEPTH_COMPONENT24,
+						 fb_size, fb_size);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+					  GL_RENDERBUFFER, rb[1]);
+	}
+
+	if (glGetError() != GL_NO_ERROR ||
+	    glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+	    GL_FRAMEBUFFER_COMPLETE) {
+		glBindFramebuffer(GL_FRAMEBUFFER, piglit_winsys_fbo);
+		glDeleteFramebuffers(1, &fbo);
+		glDeleteRenderbuffers(2, rb);
+		return 0;
+	}
+
+	glViewport(0, 0, fb_size, fb_size);
+	return fbo;
+}
+
+static void
+destroy_fbo(GLuint fbo, GLuint rb[2])
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, piglit_winsys_fbo);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(rb[1] ? 2 : 1, rb);
+}
+
+static void
+draw(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++)
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+/**
+ * Return the fill rate in pixels (times 'units_per_pixel') per second, or 0
+ * if the framebuffer configuration isn't supported. The rate is also
+ * reported to the framework under 'name'.
+ */
+static double
+run_test(const char *name, GLenum format, unsigned samples, bool blend,
+	 enum depth_mode depth_mode, unsigned units_per_pixel)
+{
+	GLuint rb[2];
+	GLuint fbo = create_fbo(format, samples, depth_mode != DEPTH_NONE,
+				rb);
+	const double scale = (double)fb_size * fb_size * units_per_pixel;
+	double rate;
+
+	if (!fbo)
+		return 0;
+
+	/* The quad is drawn at z = 0, i.e. depth 0.5 in window space. */
+	switch (depth_mode) {
+	case DEPTH_NONE:
+		break;
+	case DEPTH_ALWAYS:
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_ALWAYS);
+		glClearDepth(1);
+		break;
+	case DEPTH_PASS:
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LEQUAL);
+		glClearDepth(1);
+		break;
+	case DEPTH_REJECT:
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LESS);
+		glClearDepth(0);
+		break;
+	default:
+		assert(!"wrong depth mode");
+	}
+
+	if (blend) {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if (gpu_time) {
+		struct perf_timing timing;
+
+		perf_measure_timing(draw, 0.15, &timing);
+		perf_report_timing(name, &timing, scale);
+		rate = (timing.gpu_rate ? timing.gpu_rate : timing.rate) * scale;
+	} else {
+		double stddev;
+
+		rate = perf_measure_rate_stats(draw, 0.15, &stddev) * scale;
+		perf_report_rate(name, rate, stddev * scale);
+	}
+
+	glDisable(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+	glClearDepth(1);
+	destroy_fbo(fbo, rb);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+
+	return rate;
+}
+
+static void
+print_rate(double rate)
+{
+	if (rate == 0)
+		printf(",    n/a");
+	else if (gpu_freq_mhz)
+		printf(", %6.2f", rate / (gpu_freq_mhz * 1000000.0));
+	else
+		printf(", %6.2f", rate / 1000000000);
+	fflush(stdout);
+}
+
+static void
+print_samples_header(const char *title)
+{
+	printf("  %-29s", title);
+	for (unsigned s = 0; s < ARRAY_SIZE(sample_counts); s++)
+		printf(", %5uX", MAX2(sample_counts[s], 1));
+	printf("\n");
+}
+
+/* Render target formats x sample counts x blending. */
+static void
+run_format_tests(void)
+{
+	char name[64];
+
+	print_samples_header("Format    , Blend");
+
+	for (unsigned f = 0; f < ARRAY_SIZE(formats); f++) {
+		for (unsigned blend = 0; blend < 2; blend++) {
+			printf("  %-10s, %-16s", formats[f].name,
+			       blend ? "blend" : "no blend");
+
+			for (unsigned s = 0; s < ARRAY_SIZE(sample_counts); s++) {
+				snprintf(name, sizeof(name), "%s %ux %s",
+					 formats[f].name,
+					 MAX2(sample_counts[s], 1),
+					 blend ? "blend" : "no blend");
+				print_rate(run_test(name, formats[f].format,
+						    sample_counts[s], blend,
+						    DEPTH_NONE, 1));
+			}
+			printf("\n");
+		}
+	}
+}
+
+/* Depth test modes x sample counts. */
+static void
+run_depth_tests(void)
+{
+	char name[64];
+
+	print_samples_header("Depth mode");
+
+	for (unsigned d = 0; d < NUM_DEPTH_MODES; d++) {
+		printf("  %-29s", depth_mode_names[d]);
+
+		for (unsigned s = 0; s < ARRAY_SIZE(sample_counts); s++) {
+			snprintf(name, sizeof(name), "RGBA8 %ux %s",
+				 MAX2(sample_counts[s], 1),
+				 depth_mode_names[d]);
+			print_rate(run_test(name, GL_RGBA8, sample_counts[s],
+					    false, d, 1));
+		}
+		printf("\n");
+	}
+}
+
+/* Fragment shader ALU and texture load, single-sampled RGBA8. */
+static void
+run_shader_tests(void)
+{
+	static const unsigned alu_counts[] = {0, 4, 16, 64};
+	static const unsigned tex_counts[] = {1, 2, 4, 8};
+	char name[64];
+	GLuint prog;
+
+	printf("  %-29s", "ALU ops / fragment");
+	for (unsigned i = 0; i < ARRAY_SIZE(alu_counts); i++)
+		printf(", %6u", alu_counts[i]);
+	printf("\n  %-29s", gpu_freq_mhz ? "pixels/clock" : "Gpixels/s");
+
+	for (unsigned i = 0; i < ARRAY_SIZE(alu_counts); i++) {
+		prog = setup_program(alu_counts[i], 0);
+		snprintf(name, sizeof(name), "%u ALU ops", alu_counts[i]);
+		print_rate(run_test(name, GL_RGBA8, 0, false, DEPTH_NONE, 1));
+		glDeleteProgram(prog);
+	}
+	printf("\n");
+
+	printf("  %-29s", "Textures / fragment");
+	for (unsigned i = 0; i < ARRAY_SIZE(tex_counts); i++)
+		printf(", %6u", tex_counts[i]);
+	printf("\n  %-29s", gpu_freq_mhz ? "texels/clock" : "Gtexels/s");
+
+	for (unsigned i = 0; i < ARRAY_SIZE(tex_counts); i++) {
+		prog = setup_program(0, tex_counts[i]);
+		snprintf(name, sizeof(name), "%u textures", tex_counts[i]);
+		print_rate(run_test(name, GL_RGBA8, 0, false, DEPTH_NONE,
+				    tex_counts[i]));
+		glDeleteProgram(prog);
+	}
+	printf("\n");
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	GLuint prog;
+
+	printf("  Measuring %s, %ux%u render target\n",
+	       gpu_freq_mhz ? "pixels/clock" : "Gpixels/second",
+	       fb_size, fb_size);
+
+	prog = setup_program(0, 0);
+	run_format_tests();
+	run_depth_tests();
+	glDeleteProgram(prog);
+
+	run_shader_tests();
+
+	piglit_report_result(PIGLIT_PASS);
+	return PIGLIT_PASS;
+}
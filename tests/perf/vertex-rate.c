@@ -0,0 +1,459 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Measure vertex fetch and index buffer throughput in vertices per second.
+ *
+ * Rasterization is discarded, so only vertex fetch and the vertex shader
+ * are measured.
+ *
+ * Variables:
+ * - number of vec4 vertex attributes
+ * - attribute component type: float32, float16, unorm8, snorm16 and
+ *   snorm 2_10_10_10
+ * - interleaved attributes in one buffer vs. one buffer per attribute
+ * - index type: none (glDrawArrays), ubyte, ushort, uint
+ * - primitive restart
+ * - instancing with a per-instance attribute
+ *
+ * All index types reference the same small set of vertices, so that only
+ * the cost of fetching the indices differs between them.
+ */
+
+#include "common.h"
+#include <stdbool.h>
+#undef NDEBUG
+#include <assert.h>
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_core_version = 33;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+/* Vertices per draw call. Divisible by 3, by the restart interval and by
+ * the number of instances times 3.
+ */
+#define NUM_VERTICES (12 * 16 * 512)
+
+/* Vertices referenced by index buffers, fits in ubyte indices without
+ * using the restart index.
+ */
+#define NUM_INDEXED_VERTICES 252
+
+/* Indices between restart indices. */
+#define RESTART_INTERVAL 12
+
+#define NUM_INSTANCES 16
+
+#define MAX_ATTRIBS 16
+
+enum vertex_type {
+	VT_FLOAT,
+	VT_HALF,
+	VT_UNORM8,
+	VT_SNORM16,
+	VT_2_10_10_10,
+	NUM_VERTEX_TYPES,
+};
+
+static const struct {
+	const char *name;
+	GLenum type;
+	GLboolean normalized;
+	/* Bytes per vec4 attribute. */
+	unsigned size;
+} vertex_types[] = {
+	[VT_FLOAT]	= {"float32",	GL_FLOAT,		GL_FALSE, 16},
+	[VT_HALF]	= {"float16",	GL_HALF_FLOAT,		GL_FALSE, 8},
+	[VT_UNORM8]	= {"unorm8",	GL_UNSIGNED_BYTE,	GL_TRUE,  4},
+	[VT_SNORM16]	= {"snorm16",	GL_SHORT,		GL_TRUE,  8},
+	[VT_2_10_10_10]	= {"2_10_10_10", GL_INT_2_10_10_10_REV,	GL_TRUE,  4},
+};
+
+static const unsigned attrib_counts[] = {1, 4, 8, 16};
+
+static const struct {
+	const char *name;
+	GLenum type;
+	unsigned size;
+	GLuint restart_index;
+} index_types[] = {
+	{"no index",	GL_NONE,		0, 0},
+	{"ubyte",	GL_UNSIGNED_BYTE,	1, 0xff},
+	{"ushort",	GL_UNSIGNED_SHORT,	2, 0xffff},
+	{"uint",	GL_UNSIGNED_INT,	4, 0xffffffff},
+};
+
+enum index_mode {
+	INDEX_PLAIN,
+	INDEX_RESTART,
+	INDEX_INSTANCED,
+	NUM_INDEX_MODES,
+};
+
+static const char *index_mode_names[] = {
+	"plain",
+	"restart",
+	"instanced",
+};
+
+static GLint max_attribs;
+static GLuint vao, vbos[MAX_ATTRIBS], ibo;
+
+/* Draw parameters used by draw(). */
+static GLenum index_type;
+static unsigned draw_count, draw_instances;
+
+void
+piglit_init(int argc, char **argv)
+{
+	piglit_require_gl_version(33);
+
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attribs);
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glGenBuffers(MAX_ATTRIBS, vbos);
+	glGenBuffers(1, &ibo);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+}
+
+static GLuint
+setup_program(unsigned num_attribs)
+{
+	char vs[512];
+	GLuint prog;
+
+	/* Sum all attributes, so that none of them is dead. */
+	snprintf(vs, sizeof(vs),
+		 "#version 330\n"
+		 "layout(location = 0) in vec4 a[%u];\n"
+		 "void main() {\n"
+		 "	vec4 s = a[0];\n"
+		 "	for (int i = 1; i < %u; i++)\n"
+		 "		s += a[i];\n"
+		 "	gl_Position = s;\n"
+		 "}\n", num_attribs, num_attribs);
+
+	prog = piglit_build_simple_program_multiple_shaders(
+			GL_VERTEX_SHADER, vs, 0);
+	glUseProgram(prog);
+	return prog;
+}
+
+static GLuint
+pack_snorm10(float f)
+{
+	return (GLuint)(GLint)(f * 511) & 0x3ff;
+}
+
+/** Write the vec4 'v' with components in [0, 1] as 'type' to 'dst'. */
+static void
+write_vec4(void *dst, enum vertex_type type, const float v[4])
+{
+	unsigned c;
+
+	switch (type) {
+	case VT_FLOAT:
+		memcpy(dst, v, 16);
+		break;
+	case VT_HALF:
+		for (c = 0; c < 4; c++)
+			((GLushort *)dst)[c] = piglit_half_from_float(v[c]);
+		break;
+	case VT_UNORM8:
+		for (c = 0; c < 4; c++)
+			((GLubyte *)dst)[c] = v[c] * 255;
+		break;
+	case VT_SNORM16:
+		for (c = 0; c < 4; c++)
+			((GLshort *)dst)[c] = v[c] * 32767;
+		break;
+	case VT_2_10_10_10:
+		*(GLuint *)dst = pack_snorm10(v[0]) |
+				 pack_snorm10(v[1]) << 10 |
+				 pack_snorm10(v[2]) << 20 |
+				 (GLuint)(v[3] >= 0.5) << 30;
+		break;
+	default:
+		assert(!"wrong vertex type");
+	}
+}
+
+/**
+ * Fill the vertex buffers with NUM_VERTICES vertices of 'num_attribs'
+ * attributes, and set up the vertex arrays. If 'instanced', the last
+ * attribute advances per instance instead of per vertex.
+ */
+static void
+setup_attribs(enum vertex_type type, unsigned num_attribs, bool interleaved,
+	      bool instanced)
+{
+	const unsigned size = vertex_types[type].size;
+	const unsigned stride = interleaved ? size * num_attribs : size;
+	const unsigned num_buffers = interleaved ? 1 : num_attribs;
+	uint8_t *data = malloc(NUM_VERTICES * size * num_attribs);
+
+	assert(data);
+
+	for (unsigned v = 0; v < NUM_VERTICES; v++) {
+		for (unsigned a = 0; a < num_attribs; a++) {
+			float vec[4];
+			unsigned offset = interleaved ?
+				v * stride + a * size :
+				(a * NUM_VERTICES + v) * size;
+
+			for (unsigned c = 0; c < 4; c++)
+				vec[c] = ((v * 7 + a * 3 + c) % 16) / 16.0;
+			write_vec4(data + offset, type, vec);
+		}
+	}
+
+	for (unsigned b = 0; b < num_buffers; b++) {
+		glBindBuffer(GL_ARRAY_BUFFER, vbos[b]);
+		glBufferData(GL_ARRAY_BUFFER, NUM_VERTICES * stride,
+			     data + b * NUM_VERTICES * size, GL_STATIC_DRAW);
+	}
+	free(data);
+
+	for (unsigned a = 0; a < MAX_ATTRIBS; a++) {
+		if (a >= num_attribs) {
+			glDisableVertexAttribArray(a);
+			continue;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbos[interleaved ? 0 : a]);
+		glVertexAttribPointer(a, 4, vertex_types[type].type,
+				      vertex_types[type].normalized, stride,
+				      (void *)(uintptr_t)(interleaved ?
+							  a * size : 0));
+		glVertexAttribDivisor(a, instanced && a == num_attribs - 1);
+		glEnableVertexAttribArray(a);
+	}
+}
+
+static void
+write_index(uint8_t *data, unsigned size, unsigned n, GLuint index)
+{
+	switch (size) {
+	case 1:
+		data[n] = index;
+		break;
+	case 2:
+		((GLushort *)data)[n] = index;
+		break;
+	default:
+		((GLuint *)data)[n] = index;
+		break;
+	}
+}
+
+/**
+ * Fill the index buffer with indices for NUM_VERTICES vertices, with a
+ * restart index every RESTART_INTERVAL indices if 'restart'. Return the
+ * number of indices.
+ */
+static unsigned
+setup_indices(unsigned index, bool restart)
+{
+	const unsigned size = index_types[index].size;
+	const GLuint restart_index = index_types[index].restart_index;
+	uint8_t *data = malloc(NUM_VERTICES / RESTART_INTERVAL *
+			       (RESTART_INTERVAL + 1) * size);
+	unsigned n = 0;
+
+	assert(data);
+
+	for (unsigned v = 0; v < NUM_VERTICES; v++) {
+		GLuint i = v % NUM_INDEXED_VERTICES;
+
+		if (restart && v && v % RESTART_INTERVAL == 0)
+			write_index(data, size, n++, restart_index);
+		write_index(data, size, n++, i);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, n * size, data, GL_STATIC_DRAW);
+	free(data);
+
+	if (restart) {
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(restart_index);
+	} else {
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+	return n;
+}
+
+static void
+draw(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		if (index_type == GL_NONE)
+			glDrawArraysInstanced(GL_TRIANGLES, 0, draw_count,
+					      draw_instances);
+		else
+			glDrawElementsInstanced(GL_TRIANGLES, draw_count,
+						index_type, NULL,
+						draw_instances);
+	}
+}
+
+/**
+ * Measure and report the vertex rate of the current draw parameters.
+ * Every draw processes NUM_VERTICES vertices.
+ */
+static double
+run_test(const char *name)
+{
+	double rate, stddev;
+
+	rate = perf_measure_rate_stats(draw, 0.15, &stddev) * NUM_VERTICES;
+	perf_report_rate(name, rate, stddev * NUM_VERTICES);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+	return rate;
+}
+
+static void
+print_rate(double rate)
+{
+	if (rate == 0)
+		printf(",    n/a");
+	else
+		printf(", %6.0f", rate / 1000000);
+	fflush(stdout);
+}
+
+/* Vertex types x attribute counts x interleaved or separate buffers. */
+static void
+run_attrib_tests(void)
+{
+	GLuint progs[ARRAY_SIZE(attrib_counts)];
+	char name[64];
+
+	for (unsigned i = 0; i < ARRAY_SIZE(attrib_counts); i++) {
+		if (attrib_counts[i] <= max_attribs)
+			progs[i] = setup_program(attrib_counts[i]);
+		else
+			progs[i] = 0;
+	}
+
+	printf("  %-25s", "Mvertices/s, attributes");
+	for (unsigned i = 0; i < ARRAY_SIZE(attrib_counts); i++)
+		printf(", %6u", attrib_counts[i]);
+	printf("\n");
+
+	index_type = GL_NONE;
+	draw_count = NUM_VERTICES;
+	draw_instances = 1;
+
+	for (unsigned t = 0; t < NUM_VERTEX_TYPES; t++) {
+		for (unsigned interleaved = 0; interleaved < 2; interleaved++) {
+			printf("  %-10s, %-12s", vertex_types[t].name,
+			       interleaved ? "interleaved" : "separate");
+
+			for (unsigned i = 0; i < ARRAY_SIZE(attrib_counts); i++) {
+				if (!progs[i]) {
+					print_rate(0);
+					continue;
+				}
+
+				glUseProgram(progs[i]);
+				setup_attribs(t, attrib_counts[i], interleaved,
+					      false);
+				snprintf(name, sizeof(name), "%s x%u %s",
+					 vertex_types[t].name,
+					 attrib_counts[i],
+					 interleaved ? "interleaved" :
+						       "separate");
+				print_rate(run_test(name));
+			}
+			printf("\n");
+		}
+	}
+
+	for (unsigned i = 0; i < ARRAY_SIZE(attrib_counts); i++)
+		glDeleteProgram(progs[i]);
+}
+
+/* Index types x primitive restart or instancing, 4 float32 attributes. */
+static void
+run_index_tests(void)
+{
+	GLuint prog = setup_program(4);
+	char name[64];
+
+	printf("  %-25s", "Mvertices/s, index type");
+	for (unsigned m = 0; m < NUM_INDEX_MODES; m++)
+		printf(", %9s", index_mode_names[m]);
+	printf("\n");
+
+	for (unsigned i = 0; i < ARRAY_SIZE(index_types); i++) {
+		printf("  %-25s", index_types[i].name);
+		index_type = index_types[i].type;
+
+		for (unsigned m = 0; m < NUM_INDEX_MODES; m++) {
+			const bool restart = m == INDEX_RESTART;
+			const bool instanced = m == INDEX_INSTANCED;
+
+			if (index_type == GL_NONE && restart) {
+				printf(",       n/a");
+				continue;
+			}
+
+			setup_attribs(VT_FLOAT, 4, true, instanced);
+			draw_instances = instanced ? NUM_INSTANCES : 1;
+
+			if (index_type == GL_NONE)
+				draw_count = NUM_VERTICES;
+			else
+				draw_count = setup_indices(i, restart);
+			draw_count /= draw_instances;
+
+			snprintf(name, sizeof(name), "%s %s",
+				 index_types[i].name, index_mode_names[m]);
+			printf(", %9.0f", run_test(name) / 1000000);
+			fflush(stdout);
+		}
+		printf("\n");
+	}
+
+	glDisable(GL_PRIMITIVE_RESTART);
+	glDeleteProgram(prog);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	run_attrib_tests();
+	printf("\n");
+	run_index_tests();
+
+	piglit_report_result(PIGLIT_PASS);
+	return PIGLIT_PASS;
+}
@@ -0,0 +1,40 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""A profile of the OpenGL performance tests.
+
+The tests report their measurements in the results, use --perf-baseline to
+compare them against a previous run, and "piglit summary perf" to view the
+comparison.
+"""
+
+from framework.profile import TestProfile
+from framework.test import PiglitPerfTest
+
+__all__ = ['profile']
+
+profile = TestProfile()
+
+with profile.test_list.group_manager(PiglitPerfTest, 'perf') as g:
+    g(['compute-rate'])
+    g(['ext_image_dma_buf_import-bench'], 'dma-buf-import')
+    g(['fill-rate'])
+    g(['vertex-rate'])
@@ -19,22 +19,22 @@
 # OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 # SOFTWARE.
 
-"""Script for taking profiles in python format and serializing them to XML."""
+"""Script for taking profiles in python format and serializing them to the
+indexed profile format."""
 
 import argparse
-import gzip
 import os
 import sys
-import xml.etree.ElementTree as et
 
 sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
 
 from framework.test.piglit_test import (
-    PiglitGLTest, PiglitCLTest, ASMParserTest, BuiltInConstantsTest,
-    CLProgramTester, VkRunnerTest
+    PiglitGLTest, PiglitCLTest, PiglitPerfTest, ASMParserTest,
+    BuiltInConstantsTest, CLProgramTester, VkRunnerTest
 )
 from framework.test.shader_test import ShaderTest, MultiShaderTest
 from framework.test.glsl_parser_test import GLSLParserTest
+from framework import indexed_profile
 from framework.profile import load_test_profile
 from framework.options import OPTIONS
 
@@ -51,7 +51,7 @@ def parser():
     return args
 
 
-def _serialize_skips(test, elem):
+def _serialize_skips(test, options):
     elems = [
         ('require_shader', 'shader_version'),
         ('require_api', 'api'),
@@ -67,79 +67,76 @@ def _serialize_skips(test, elem):
         if not value:
             value = getattr(test, f, None)
         if value:
-            et.SubElement(elem, 'option', name=f, value=repr(value))
+            options[f] = repr(value)
+
+
+def _record(name, test):
+    """Return the record of a test, or None if it can't be serialized."""
+    options = {}
+    record = {'name': name, 'options': options}
+    if isinstance(test, PiglitGLTest):
+        record['type'] = 'gl_perf' if isinstance(test, PiglitPerfTest) else 'gl'
+        if test.require_platforms:
+            options['require_platforms'] = repr(test.require_platforms)
+        if test.exclude_platforms:
+            options['exclude_platforms'] = repr(test.exclude_platforms)
+        _serialize_skips(test, options)
+    elif isinstance(test, BuiltInConstantsTest):
+        record['type'] = 'gl_builtin'
+    elif isinstance(test, GLSLParserTest):
+        record['type'] = 'glsl_parser'
+        _serialize_skips(test, options)
+    elif isinstance(test, ASMParserTest):
+        record['type'] = 'asm_parser'
+        options['type_'] = repr(test.command[1])
+        options['filename'] = repr(test.filename)
+        return record
+    elif isinstance(test, ShaderTest):
+        record['type'] = 'shader'
+        _serialize_skips(test, options)
+    elif isinstance(test, MultiShaderTest):
+        record['type'] = 'multi_shader'
+        options['prog'] = repr(test.prog)
+        options['files'] = repr(test.files)
+        options['subtests'] = repr(test.subtests)
+        record['skips'] = []
+        for s in test.skips:
+            skip = {}
+            _serialize_skips(s, skip)
+            record['skips'].append(skip)
+        return record
+    elif isinstance(test, CLProgramTester):
+        record['type'] = 'cl_prog'
+        options['filename'] = repr(test.filename)
+        return record
+    elif isinstance(test, PiglitCLTest):
+        record['type'] = 'cl'
+        options['command'] = repr(test._command)
+        return record
+    elif isinstance(test, VkRunnerTest):
+        record['type'] = 'vkrunner'
+        options['filename'] = repr(test.filename)
+        return record
+    else:
+        return None
+
+    options['command'] = repr(test._command)
+    options['run_concurrent'] = repr(test.run_concurrent)
+    if test.cwd:
+        options['cwd'] = repr(test.cwd)
+    if test.env:
+        record['env'] = dict(test.env)
+    return record
 
 
 def serializer(name, profile, outfile):
-    """Take each test in the profile and write it out into the xml."""
-    # TODO: This is going to take a lot of memory
-    root = et.Element('PiglitTestList', count=str(len(profile)),
-                      name=name)
-    for name, test in profile.itertests():
-        if isinstance(test, PiglitGLTest):
-            elem = et.SubElement(root, 'Test', type='gl', name=name)
-            if test.require_platforms:
-                et.SubElement(elem, 'option', name='require_platforms',
-                              value=repr(test.require_platforms))
-            if test.exclude_platforms:
-                et.SubElement(elem, 'option', name='exclude_platforms',
-                              value=repr(test.exclude_platforms))
-            _serialize_skips(test, elem)
-        elif isinstance(test, BuiltInConstantsTest):
-            elem = et.SubElement(root, 'Test', type='gl_builtin', name=name)
-        elif isinstance(test, GLSLParserTest):
-            elem = et.SubElement(root, 'Test', type='glsl_parser', name=name)
-            _serialize_skips(test, elem)
-        elif isinstance(test, ASMParserTest):
-            elem = et.SubElement(root, 'Test', type='asm_parser', name=name)
-            et.SubElement(elem, 'option', name='type_',
-                          value=repr(test.command[1]))
-            et.SubElement(elem, 'option', name='filename',
-                          value=repr(test.filename))
-            continue
-        elif isinstance(test, ShaderTest):
-            elem = et.SubElement(root, 'Test', type='shader', name=name)
-            _serialize_skips(test, elem)
-        elif isinstance(test, MultiShaderTest):
-            elem = et.SubElement(root, 'Test', type='multi_shader', name=name)
-            et.SubElement(elem, 'option', name='prog', value=repr(test.prog))
-            et.SubElement(elem, 'option', name='files', value=repr(test.files))
-            et.SubElement(elem, 'option', name='subtests', value=repr(test.subtests))
-            skips = et.SubElement(elem, 'Skips')
-            for s in test.skips:
-                skip = et.SubElement(skips, 'Skip')
-                _serialize_skips(s, skip)
-            continue
-        elif isinstance(test, CLProgramTester):
-            elem = et.SubElement(root, 'Test', type='cl_prog', name=name)
-            et.SubElement(elem, 'option', name='filename',
-                          value=repr(test.filename))
-            continue
-        elif isinstance(test, PiglitCLTest):
-            elem = et.SubElement(root, 'Test', type='cl', name=name)
-            et.SubElement(elem, 'option', name='command', value=repr(test._command))
-            continue
-        elif isinstance(test, VkRunnerTest):
-            elem = et.SubElement(root, 'Test', type='vkrunner', name=name)
-            et.SubElement(elem, 'option', name='filename',
-                          value=repr(test.filename))
-            continue
-        else:
-            continue
-
-        et.SubElement(elem, 'option', name='command', value=repr(test._command))
-        et.SubElement(elem, 'option', name='run_concurrent',
-                      value=repr(test.run_concurrent))
-        if test.cwd:
-            et.SubElement(elem, 'option', name='cwd', value=test.cwd)
-        if test.env:
-            env = et.SubElement(elem, 'environment')
-            for k, v in test.env.items():
-                et.SubElement(env, 'env', name=k, value=v)
-
-    tree = et.ElementTree(root)
-    with gzip.open(outfile, 'wb') as f:
-        tree.write(f, encoding='utf-8', xml_declaration=True)
+    """Write each test in the profile into an indexed profile.
+
+    The tests are written as they are iterated, so the profile is never
+    held in memory a second time.
+    """
+    records = (_record(n, t) for n, t in profile.itertests())
+    indexed_profile.write(outfile, name, (r for r in records if r))
 
 
 def main():
@@ -56,6 +56,7 @@ PIGLIT_GL_TEST_CONFIG_BEGIN
 	}
 	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
 	config.khr_no_error_support = PIGLIT_NO_ERRORS;
+	config.reuse_contexts = true;
 
 	/* By default SPIR-V mode is false. It will not be enabled
 	 * unless the script includes SPIRV YES or SPIRV ONLY lines at
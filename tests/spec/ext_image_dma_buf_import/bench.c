@@ -0,0 +1,438 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * @file bench.c
+ *
+ * Benchmark importing dma-bufs as EGL images, against uploading the same
+ * data with glTexImage2D(), for a sweep of fourcc formats:
+ *
+ *  - "<fmt> import": eglCreateImageKHR()/eglDestroyImageKHR() per second.
+ *  - "<fmt> first use": imports per second, including binding the image to
+ *    a texture and waiting for a draw sampling it.
+ *  - "<fmt> teximage": the same for glTexImage2D() uploads, the cost that
+ *    importing saves.
+ *  - "<fmt> sampling, import" and "<fmt> sampling, teximage": millions of
+ *    texels per second sampled from the imported and the uploaded texture.
+ *
+ * Before measuring, the test checks that the import is zero-copy: contents
+ * written to the dma-buf through mmap() after the import must show up when
+ * sampling the image, otherwise the format warns.
+ *
+ * The dma-bufs come from GBM, so no GPU is needed: set WAFFLE_GBM_DEVICE to
+ * a vgem node, or use a software GBM backend.
+ *
+ * Usage: ext_image_dma_buf_import-bench [-fmt=<fourcc>] [-size=<n>]
+ */
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/dma-buf.h>
+
+#include "sample_common.h"
+#include "image_common.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_es_version = 20;
+	config.window_width = 512;
+	config.window_height = 512;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define MIN_DURATION 0.15
+
+struct format {
+	const char *name;
+	uint32_t fourcc;
+	unsigned cpp;
+	GLenum upload_format;	/* for the glTexImage2D() comparison */
+};
+
+static const struct format formats[] = {
+	{ "AR24", DRM_FORMAT_ARGB8888, 4, GL_RGBA },
+	{ "XR24", DRM_FORMAT_XRGB8888, 4, GL_RGBA },
+	{ "AB24", DRM_FORMAT_ABGR8888, 4, GL_RGBA },
+	{ "XB24", DRM_FORMAT_XBGR8888, 4, GL_RGBA },
+	{ "R8", DRM_FORMAT_R8, 1, GL_LUMINANCE },
+	{ "GR88", DRM_FORMAT_GR88, 2, GL_LUMINANCE_ALPHA },
+};
+
+static const char vs_src[] =
+	"attribute vec4 piglit_vertex;\n"
+	"attribute vec4 piglit_texcoords;\n"
+	"varying vec2 texcoords;\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	texcoords = piglit_texcoords.xy;\n"
+	"	gl_Position = piglit_vertex;\n"
+	"}\n";
+
+static const char fs_external_src[] =
+	"#extension GL_OES_EGL_image_external : require\n"
+	"precision mediump float;\n"
+	"uniform samplerExternalOES sampler;\n"
+	"varying vec2 texcoords;\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = texture2D(sampler, texcoords);\n"
+	"}\n";
+
+static const char fs_2d_src[] =
+	"precision mediump float;\n"
+	"uniform sampler2D sampler;\n"
+	"varying vec2 texcoords;\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = texture2D(sampler, texcoords);\n"
+	"}\n";
+
+static const struct format *only_format;
+static unsigned size = 512;
+static GLuint prog_external, prog_2d;
+
+/* State of the format being measured, for the perf_rate_func callbacks. */
+static const struct format *cur;
+static struct piglit_dma_buf *cur_buf;
+static EGLint cur_attribs[13];
+static unsigned char *cur_data;
+static GLuint cur_tex;
+
+static void
+draw(GLuint prog, unsigned w, unsigned h)
+{
+	glUseProgram(prog);
+	glViewport(0, 0, w, h);
+	piglit_draw_rect_tex(-1, -1, 2, 2, 0, 0, 1, 1);
+}
+
+static GLuint
+texture_for_image(EGLImageKHR img)
+{
+	GLuint tex = 0;
+
+	if (texture_for_egl_image(img, &tex) != PIGLIT_PASS)
+		piglit_report_result(PIGLIT_FAIL);
+	return tex;
+}
+
+static void
+import(unsigned count)
+{
+	EGLDisplay dpy = eglGetCurrentDisplay();
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		EGLImageKHR img = eglCreateImageKHR(dpy, EGL_NO_CONTEXT,
+						    EGL_LINUX_DMA_BUF_EXT,
+						    NULL, cur_attribs);
+		eglDestroyImageKHR(dpy, img);
+	}
+}
+
+static void
+import_and_use(unsigned count)
+{
+	EGLDisplay dpy = eglGetCurrentDisplay();
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		EGLImageKHR img = eglCreateImageKHR(dpy, EGL_NO_CONTEXT,
+						    EGL_LINUX_DMA_BUF_EXT,
+						    NULL, cur_attribs);
+		GLuint tex = texture_for_image(img);
+
+		draw(prog_external, 1, 1);
+		glFinish();
+
+		glDeleteTextures(1, &tex);
+		eglDestroyImageKHR(dpy, img);
+	}
+}
+
+static void
+upload_and_use(unsigned count)
+{
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		GLuint tex;
+
+		glGenTextures(1, &tex);
+		glBindTexture(GL_TEXTURE_2D, tex);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+				GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+				GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, cur->upload_format, size, size,
+			     0, cur->upload_format, GL_UNSIGNED_BYTE,
+			     cur_data);
+
+		draw(prog_2d, 1, 1);
+		glFinish();
+
+		glDeleteTextures(1, &tex);
+	}
+}
+
+static void
+sample_external(unsigned count)
+{
+	unsigned i;
+
+	glBindTexture(GL_TEXTURE_EXTERNAL_OES, cur_tex);
+	for (i = 0; i < count; i++)
+		draw(prog_external, piglit_width, piglit_height);
+}
+
+static void
+sample_2d(unsigned count)
+{
+	unsigned i;
+
+	glBindTexture(GL_TEXTURE_2D, cur_tex);
+	for (i = 0; i < count; i++)
+		draw(prog_2d, piglit_width, piglit_height);
+}
+
+/**
+ * Fill the dma-buf with 'value' through a CPU mapping of the dma-buf
+ * itself, bracketed by DMA_BUF_IOCTL_SYNC as the kernel requires.
+ */
+static bool
+fill_dma_buf(unsigned char value)
+{
+	struct dma_buf_sync sync = { DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE };
+	size_t len = cur_buf->offset[0] + (size_t) cur_buf->stride[0] * size;
+	void *map;
+
+	map = mmap(NULL, len, PROT_WRITE, MAP_SHARED, cur_buf->fd, 0);
+	if (map == MAP_FAILED) {
+		printf("%s: dma-buf can't be mapped\n", cur->name);
+		return false;
+	}
+
+	ioctl(cur_buf->fd, DMA_BUF_IOCTL_SYNC, &sync);
+	memset((char *) map + cur_buf->offset[0], value,
+	       len - cur_buf->offset[0]);
+	sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_WRITE;
+	ioctl(cur_buf->fd, DMA_BUF_IOCTL_SYNC, &sync);
+
+	munmap(map, len);
+	return true;
+}
+
+/**
+ * Whether sampling the imported texture returns 'value' in the red
+ * channel. Every byte of the buffer is 'value', so that holds for all the
+ * formats regardless of their channel order.
+ */
+static bool
+samples_value(unsigned char value)
+{
+	const float expected = value / 255.0;
+	GLubyte pixel[4];
+
+	glBindTexture(GL_TEXTURE_EXTERNAL_OES, cur_tex);
+	draw(prog_external, 1, 1);
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+
+	return fabs(pixel[0] / 255.0 - expected) <= 1.0 / 255.0;
+}
+
+static void
+report(const char *what, double rate, double stddev, double scale)
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "%s %s", cur->name, what);
+	printf("%-24s %12.2f\n", name, rate * scale);
+	perf_report_rate(name, rate * scale, stddev * scale);
+}
+
+static enum piglit_result
+bench_format(const struct format *fmt)
+{
+	EGLDisplay dpy = eglGetCurrentDisplay();
+	enum piglit_result result = PIGLIT_PASS;
+	double rate, stddev;
+	EGLImageKHR img;
+	unsigned i = 0;
+
+	cur = fmt;
+	cur_data = malloc((size_t) size * size * fmt->cpp);
+	memset(cur_data, 0x40, (size_t) size * size * fmt->cpp);
+
+	if (piglit_create_dma_buf(size, size, fmt->fourcc, cur_data,
+				  &cur_buf) != PIGLIT_PASS) {
+		printf("%s: dma-buf can't be created\n", fmt->name);
+		free(cur_data);
+		return PIGLIT_SKIP;
+	}
+
+	cur_attribs[i++] = EGL_WIDTH;
+	cur_attribs[i++] = size;
+	cur_attribs[i++] = EGL_HEIGHT;
+	cur_attribs[i++] = size;
+	cur_attribs[i++] = EGL_LINUX_DRM_FOURCC_EXT;
+	cur_attribs[i++] = fmt->fourcc;
+	cur_attribs[i++] = EGL_DMA_BUF_PLANE0_FD_EXT;
+	cur_attribs[i++] = cur_buf->fd;
+	cur_attribs[i++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT;
+	cur_attribs[i++] = cur_buf->offset[0];
+	cur_attribs[i++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;
+	cur_attribs[i++] = cur_buf->stride[0];
+	cur_attribs[i++] = EGL_NONE;
+
+	img = eglCreateImageKHR(dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT,
+				NULL, cur_attribs);
+	if (!img) {
+		/* EGL may not support the format, this is not an error. */
+		printf("%s: import not supported\n", fmt->name);
+		result = PIGLIT_SKIP;
+		goto done;
+	}
+	cur_tex = texture_for_image(img);
+
+	/* Zero-copy check: the image must see later writes to the buffer. */
+	if (!samples_value(0x40)) {
+		printf("%s: imported image has the wrong contents\n",
+		       fmt->name);
+		result = PIGLIT_FAIL;
+		goto destroy;
+	}
+	if (!fill_dma_buf(0xc0) || !samples_value(0xc0)) {
+		printf("%s: import is not zero-copy, writes to the dma-buf "
+		       "don't reach the image\n", fmt->name);
+		result = PIGLIT_WARN;
+	}
+
+	rate = perf_measure_rate_stats(import, MIN_DURATION, &stddev);
+	report("import", rate, stddev, 1.0);
+
+	rate = perf_measure_rate_stats(import_and_use, MIN_DURATION, &stddev);
+	report("first use", rate, stddev, 1.0);
+
+	rate = perf_measure_rate_stats(upload_and_use, MIN_DURATION, &stddev);
+	report("teximage", rate, stddev, 1.0);
+
+	rate = perf_measure_rate_stats(sample_external, MIN_DURATION, &stddev);
+	report("sampling, import", rate, stddev,
+	       piglit_width * piglit_height / 1e6);
+
+	glDeleteTextures(1, &cur_tex);
+	glGenTextures(1, &cur_tex);
+	glBindTexture(GL_TEXTURE_2D, cur_tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, fmt->upload_format, size, size, 0,
+		     fmt->upload_format, GL_UNSIGNED_BYTE, cur_data);
+
+	rate = perf_measure_rate_stats(sample_2d, MIN_DURATION, &stddev);
+	report("sampling, teximage", rate, stddev,
+	       piglit_width * piglit_height / 1e6);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		result = PIGLIT_FAIL;
+
+destroy:
+	glDeleteTextures(1, &cur_tex);
+	eglDestroyImageKHR(dpy, img);
+done:
+	/* EGL doesn't take ownership of the descriptor. */
+	close(cur_buf->fd);
+	piglit_destroy_dma_buf(cur_buf);
+	free(cur_data);
+	return result;
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	enum piglit_result result = PIGLIT_SKIP;
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		enum piglit_result r;
+
+		if (only_format && only_format != &formats[i])
+			continue;
+
+		r = bench_format(&formats[i]);
+		piglit_report_subtest_result(r, "%s", formats[i].name);
+		piglit_merge_result(&result, r);
+	}
+
+	return result;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	EGLDisplay egl_dpy = eglGetCurrentDisplay();
+	int i;
+
+	piglit_require_egl_extension(egl_dpy, "EGL_EXT_image_dma_buf_import");
+	piglit_require_extension("GL_OES_EGL_image_external");
+
+	for (i = 1; i < argc; i++) {
+		if (!strncmp(argv[i], "-fmt=", 5)) {
+			unsigned j;
+
+			for (j = 0; j < ARRAY_SIZE(formats); j++) {
+				if (!strcmp(argv[i] + 5, formats[j].name)) {
+					only_format = &formats[j];
+					break;
+				}
+			}
+			if (!only_format) {
+				fprintf(stderr, "unsupported format: %s\n",
+					argv[i] + 5);
+				piglit_report_result(PIGLIT_SKIP);
+			}
+		} else if (!strncmp(argv[i], "-size=", 6)) {
+			size = strtoul(argv[i] + 6, NULL, 0);
+			if (size == 0 || size % 2) {
+				fprintf(stderr, "size must be even\n");
+				piglit_report_result(PIGLIT_FAIL);
+			}
+		} else {
+			fprintf(stderr, "unknown argument %s\n", argv[i]);
+		}
+	}
+
+	prog_external = piglit_build_simple_program(vs_src, fs_external_src);
+	prog_2d = piglit_build_simple_program(vs_src, fs_2d_src);
+	glUseProgram(prog_external);
+	glUniform1i(glGetUniformLocation(prog_external, "sampler"), 0);
+	glUseProgram(prog_2d);
+	glUniform1i(glGetUniformLocation(prog_2d, "sampler"), 0);
+
+	/* Rows of the R8 and GR88 uploads aren't always 4-byte aligned. */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file threaded-buffer-map.c
+ *
+ * Map buffers from several threads with shared contexts. Each round, every
+ * buffer is mapped by a different worker than in the round before, which
+ * checks the data written by the previous worker and writes its own.
+ */
+
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_core_version = 32;
+	config.supports_gl_compat_version = 32;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+	config.khr_no_error_support = PIGLIT_NO_ERRORS;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define NUM_WORKERS 4
+#define NUM_BUFFERS 32
+#define NUM_ROUNDS 16
+#define BUFFER_WORDS (64 * 1024)
+
+struct map {
+	unsigned index;
+	GLuint buf;
+	unsigned round;
+};
+
+static uint32_t
+buffer_word(unsigned buf, unsigned round, unsigned i)
+{
+	return (buf << 24) ^ (round << 16) ^ i;
+}
+
+static bool
+check_words(const uint32_t *words, unsigned buf, unsigned round)
+{
+	unsigned i;
+
+	for (i = 0; i < BUFFER_WORDS; i++) {
+		if (words[i] != buffer_word(buf, round, i)) {
+			printf("buffer %u, round %u: word %u is 0x%08x, "
+			       "expected 0x%08x\n", buf, round, i, words[i],
+			       buffer_word(buf, round, i));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool
+map_buffer(unsigned worker, void *data)
+{
+	const struct map *m = data;
+	bool pass = true;
+	uint32_t *words;
+	unsigned i;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m->buf);
+	words = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0,
+				 BUFFER_WORDS * sizeof(uint32_t),
+				 GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+	if (!words) {
+		printf("buffer %u, round %u: mapping failed\n",
+		       m->index, m->round);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return false;
+	}
+
+	if (m->round > 0)
+		pass = check_words(words, m->index, m->round - 1);
+
+	for (i = 0; i < BUFFER_WORDS; i++)
+		words[i] = buffer_word(m->index, m->round, i);
+
+	if (!glUnmapBuffer(GL_COPY_WRITE_BUFFER))
+		pass = false;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	return piglit_check_gl_error(GL_NO_ERROR) && pass;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	struct map maps[NUM_BUFFERS];
+	struct piglit_worker_pool *pool;
+	GLuint bufs[NUM_BUFFERS];
+	bool pass = true;
+	unsigned r, b;
+
+	glGenBuffers(NUM_BUFFERS, bufs);
+	for (b = 0; b < NUM_BUFFERS; b++) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, bufs[b]);
+		glBufferData(GL_COPY_WRITE_BUFFER,
+			     BUFFER_WORDS * sizeof(uint32_t), NULL,
+			     GL_DYNAMIC_DRAW);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	pool = piglit_worker_pool_create(NUM_WORKERS);
+	if (!pool) {
+		printf("Shared contexts are not supported\n");
+		piglit_report_result(PIGLIT_SKIP);
+	}
+
+	for (r = 0; r < NUM_ROUNDS && pass; r++) {
+		for (b = 0; b < NUM_BUFFERS; b++) {
+			maps[b].index = b;
+			maps[b].buf = bufs[b];
+			maps[b].round = r;
+			piglit_worker_pool_submit(pool, b + r, map_buffer,
+						  &maps[b]);
+		}
+
+		pass = piglit_worker_pool_finish(pool) && pass;
+	}
+
+	piglit_worker_pool_destroy(pool);
+
+	/* Check the last round from the test's context too. */
+	for (b = 0; b < NUM_BUFFERS && pass; b++) {
+		const uint32_t *words;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, bufs[b]);
+		words = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0,
+					 BUFFER_WORDS * sizeof(uint32_t),
+					 GL_MAP_READ_BIT);
+		pass = words && check_words(words, b, NUM_ROUNDS - 1);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(NUM_BUFFERS, bufs);
+
+	pass = piglit_check_gl_error(GL_NO_ERROR) && pass;
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	/* Should never be reached */
+	return PIGLIT_FAIL;
+}
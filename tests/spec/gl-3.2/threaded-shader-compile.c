@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file threaded-shader-compile.c
+ *
+ * Compile and link programs from several threads with shared contexts, then
+ * draw with all of them in the test's context.
+ */
+
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_core_version = 32;
+	config.supports_gl_compat_version = 32;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+	config.khr_no_error_support = PIGLIT_NO_ERRORS;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define NUM_WORKERS 4
+#define GRID 8
+#define NUM_PROGRAMS (GRID * GRID)
+
+static const char vs_source[] =
+	"#version 150\n"
+	"in vec4 piglit_vertex;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = piglit_vertex;\n"
+	"}\n";
+
+static const char fs_template[] =
+	"#version 150\n"
+	"out vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	color = vec4(%f, %f, %f, 1.0);\n"
+	"}\n";
+
+static GLuint progs[NUM_PROGRAMS];
+static float colors[NUM_PROGRAMS][4];
+
+static bool
+build_program(unsigned worker, void *data)
+{
+	unsigned i = (GLuint *) data - progs;
+	char fs_source[sizeof(fs_template) + 64];
+	GLuint vs, fs, prog;
+	bool pass;
+
+	snprintf(fs_source, sizeof(fs_source), fs_template,
+		 colors[i][0], colors[i][1], colors[i][2]);
+
+	vs = piglit_compile_shader_text_nothrow(GL_VERTEX_SHADER, vs_source,
+						true);
+	fs = piglit_compile_shader_text_nothrow(GL_FRAGMENT_SHADER, fs_source,
+						true);
+	if (!vs || !fs) {
+		glDeleteShader(vs);
+		glDeleteShader(fs);
+		return false;
+	}
+
+	prog = glCreateProgram();
+	glAttachShader(prog, vs);
+	glAttachShader(prog, fs);
+	glBindAttribLocation(prog, PIGLIT_ATTRIB_POS, "piglit_vertex");
+	glLinkProgram(prog);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	pass = piglit_link_check_status(prog);
+	progs[i] = prog;
+
+	return piglit_check_gl_error(GL_NO_ERROR) && pass;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	struct piglit_worker_pool *pool;
+	bool pass;
+	unsigned i;
+
+	/* Check for GLSL once before the workers do, they would all report
+	 * the same result.
+	 */
+	piglit_require_GLSL();
+
+	for (i = 0; i < NUM_PROGRAMS; i++) {
+		colors[i][0] = ((i * 37) % 256) / 255.0;
+		colors[i][1] = ((i * 91 + 64) % 256) / 255.0;
+		colors[i][2] = ((i * 13 + 128) % 256) / 255.0;
+		colors[i][3] = 1.0;
+	}
+
+	pool = piglit_worker_pool_create(NUM_WORKERS);
+	if (!pool) {
+		printf("Shared contexts are not supported\n");
+		piglit_report_result(PIGLIT_SKIP);
+	}
+
+	for (i = 0; i < NUM_PROGRAMS; i++)
+		piglit_worker_pool_submit(pool, i, build_program, &progs[i]);
+
+	pass = piglit_worker_pool_finish(pool);
+	piglit_worker_pool_destroy(pool);
+
+	if (!pass)
+		piglit_report_result(PIGLIT_FAIL);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	const int w = piglit_width / GRID, h = piglit_height / GRID;
+	bool pass = true;
+	unsigned i;
+
+	glClearColor(0.0, 0.0, 0.0, 0.0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	for (i = 0; i < NUM_PROGRAMS; i++) {
+		glUseProgram(progs[i]);
+		piglit_draw_rect(-1.0 + 2.0 * (i % GRID) / GRID,
+				 -1.0 + 2.0 * (i / GRID) / GRID,
+				 2.0 / GRID, 2.0 / GRID);
+	}
+	glUseProgram(0);
+
+	for (i = 0; i < NUM_PROGRAMS; i++) {
+		pass = piglit_probe_rect_rgba(w * (i % GRID) + 1,
+					      h * (i / GRID) + 1,
+					      w - 2, h - 2, colors[i]) && pass;
+	}
+
+	pass = piglit_check_gl_error(GL_NO_ERROR) && pass;
+
+	piglit_present_results();
+
+	return pass ? PIGLIT_PASS : PIGLIT_FAIL;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file threaded-texture-upload.c
+ *
+ * Upload to textures from several threads with shared contexts. Each round,
+ * every texture is uploaded by a different worker than in the round before,
+ * so that the workers also depend on each other's uploads being complete
+ * at the fences between the rounds.
+ */
+
+#include "piglit-util-gl.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_core_version = 32;
+	config.supports_gl_compat_version = 32;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+	config.khr_no_error_support = PIGLIT_NO_ERRORS;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define NUM_WORKERS 4
+#define NUM_TEXTURES 32
+#define NUM_ROUNDS 16
+#define TEX_SIZE 128
+
+struct upload {
+	GLuint tex;
+	unsigned round;
+};
+
+static void
+texture_color(unsigned tex, unsigned round, GLubyte color[4])
+{
+	color[0] = tex * 37 + round * 11;
+	color[1] = tex * 13 + round * 61;
+	color[2] = tex * 97 + round * 29;
+	color[3] = 255 - round;
+}
+
+static bool
+upload(unsigned worker, void *data)
+{
+	const struct upload *u = data;
+	GLubyte *pixels = malloc(TEX_SIZE * TEX_SIZE * 4);
+	GLubyte color[4];
+	unsigned i;
+
+	texture_color(u->tex, u->round, color);
+	for (i = 0; i < TEX_SIZE * TEX_SIZE; i++)
+		memcpy(&pixels[i * 4], color, 4);
+
+	glBindTexture(GL_TEXTURE_2D, u->tex);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEX_SIZE, TEX_SIZE,
+			GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	free(pixels);
+
+	return piglit_check_gl_error(GL_NO_ERROR);
+}
+
+static bool
+check_textures(const GLuint *texs, unsigned round)
+{
+	bool pass = true;
+	unsigned t, c;
+
+	for (t = 0; t < NUM_TEXTURES; t++) {
+		GLubyte color[4];
+		float expected[4];
+
+		texture_color(texs[t], round, color);
+		for (c = 0; c < 4; c++)
+			expected[c] = color[c] / 255.0;
+
+		/* Bind again to see the changes of the workers. */
+		glBindTexture(GL_TEXTURE_2D, texs[t]);
+		if (!piglit_probe_texel_rect_rgba(GL_TEXTURE_2D, 0, 0, 0,
+						  TEX_SIZE, TEX_SIZE,
+						  expected)) {
+			printf("  texture %u after round %u\n", t, round);
+			pass = false;
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return pass;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	struct upload uploads[NUM_TEXTURES];
+	struct piglit_worker_pool *pool;
+	GLuint texs[NUM_TEXTURES];
+	bool pass = true;
+	unsigned r, t;
+
+	glGenTextures(NUM_TEXTURES, texs);
+	for (t = 0; t < NUM_TEXTURES; t++) {
+		glBindTexture(GL_TEXTURE_2D, texs[t]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEX_SIZE, TEX_SIZE, 0,
+			     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	pool = piglit_worker_pool_create(NUM_WORKERS);
+	if (!pool) {
+		printf("Shared contexts are not supported\n");
+		piglit_report_result(PIGLIT_SKIP);
+	}
+
+	for (r = 0; r < NUM_ROUNDS && pass; r++) {
+		for (t = 0; t < NUM_TEXTURES; t++) {
+			uploads[t].tex = texs[t];
+			uploads[t].round = r;
+			piglit_worker_pool_submit(pool, t + r, upload,
+						  &uploads[t]);
+		}
+
+		pass = piglit_worker_pool_finish(pool) && pass;
+
+		/* Checking every round would serialize the workers with
+		 * the main thread, only do it now and then.
+		 */
+		if (r % 4 == 3 || r == NUM_ROUNDS - 1)
+			pass = check_textures(texs, r) && pass;
+	}
+
+	piglit_worker_pool_destroy(pool);
+	glDeleteTextures(NUM_TEXTURES, texs);
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	/* Should never be reached */
+	return PIGLIT_FAIL;
+}
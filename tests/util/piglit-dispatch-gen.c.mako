@@ -68,6 +68,8 @@ resolve_${f0.name}(void)
 % endif
 
 % endfor
+>-------if (resolving_all)
+>------->-------return NULL;
 >-------unsupported("${f0.name}");
 >-------return piglit_dispatch_${f0.name};
 }
@@ -95,6 +97,29 @@ static void reset_dispatch_pointers(void)
 % endfor
 }
 
+/* The number of dispatch pointers, one per set of aliased functions. */
+static const unsigned num_dispatch_pointers = ${len(list(gl_registry.command_alias_map))};
+
+/* Resolve every supported function, and leave the stub in place for the
+ * others. Return the number of dispatch pointers resolved.
+ */
+static unsigned resolve_all_dispatch_pointers(void)
+{
+>-------void *func;
+>-------unsigned count = 0;
+
+% for alias_set in gl_registry.command_alias_map:
+<% f0 = alias_set.primary_command %>\
+>-------func = resolve_${f0.name}();
+>-------if (func) {
+>------->-------piglit_dispatch_${f0.name} = func;
+>------->-------count++;
+>-------}
+% endfor
+
+>-------return count;
+}
+
 static const char * function_names[] = {
 % for command in gl_registry.commands:
 >-------"${command.name}",
@@ -300,6 +300,10 @@ get_wfl_ext_proc(const char *name)
  *
  * This function is safe to call multiple times--it only has an effect
  * on the first call.
+ *
+ * It must be called with the context current. If the
+ * PIGLIT_DISPATCH_EAGER environment variable is true, all functions
+ * supported by the context are resolved right away.
  */
 void
 piglit_dispatch_default_init(piglit_dispatch_api api)
@@ -340,4 +344,7 @@ piglit_dispatch_default_init(piglit_dispatch_api api)
 	}
 
 	already_initialized = true;
+
+	if (piglit_env_var_as_boolean("PIGLIT_DISPATCH_EAGER", false))
+		piglit_dispatch_resolve_all();
 }
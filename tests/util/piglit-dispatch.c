@@ -65,6 +65,13 @@ static bool is_initialized = false;
 
 static piglit_dispatch_api dispatch_api;
 
+/**
+ * True while piglit_dispatch_resolve_all() runs.  Unsupported functions
+ * and functions whose address can't be retrieved are then skipped
+ * instead of reported, the error is only reported if the test calls them.
+ */
+static bool resolving_all = false;
+
 /**
  * Generated code calls this function to verify that the dispatch
  * mechanism has been properly initialized.
@@ -88,7 +95,7 @@ static piglit_dispatch_function_ptr
 get_core_proc(const char *name, int gl_10x_version)
 {
 	piglit_dispatch_function_ptr function_pointer = get_core_proc_address(name, gl_10x_version);
-	if (function_pointer == NULL)
+	if (function_pointer == NULL && !resolving_all)
 		get_proc_address_failure(name);
 	return function_pointer;
 }
@@ -101,7 +108,7 @@ static piglit_dispatch_function_ptr
 get_ext_proc(const char *name)
 {
 	piglit_dispatch_function_ptr function_pointer = get_ext_proc_address(name);
-	if (function_pointer == NULL)
+	if (function_pointer == NULL && !resolving_all)
 		get_proc_address_failure(name);
 	return function_pointer;
 }
@@ -118,7 +125,8 @@ check_version(int required_version)
 
 /**
  * Generated code calls this function to determine whether a given
- * extension is supported.
+ * extension is supported.  The lookup is a hash set probe, so this is
+ * cheap enough to do for each alias of each resolved function.
  */
 static inline bool
 check_extension(const char *name)
@@ -236,3 +244,37 @@ piglit_dispatch_resolve_function(const char *name)
 		return function_resolvers[item_index]();
 	}
 }
+
+/**
+ * Resolve the function pointers of all functions supported by the current
+ * context at once, instead of each one on its first call.
+ *
+ * This must be called after piglit_dispatch_init(), with the context the
+ * test will use current.  Functions that are not supported keep their
+ * stub, so calling them still calls the unsupported_proc that was passed
+ * to piglit_dispatch_init().
+ *
+ * If the PIGLIT_DISPATCH_PROFILE environment variable is true, the time
+ * spent resolving is printed to stderr.
+ */
+void
+piglit_dispatch_resolve_all(void)
+{
+	int64_t start = piglit_time_get_nano();
+	unsigned count;
+
+	check_initialized();
+
+	resolving_all = true;
+	count = resolve_all_dispatch_pointers();
+	resolving_all = false;
+
+	if (piglit_env_var_as_boolean("PIGLIT_DISPATCH_PROFILE", false)) {
+		/* Aliased functions share a dispatch pointer, so count
+		 * those rather than function names.
+		 */
+		fprintf(stderr, "piglit-dispatch: resolved %u of %u dispatch "
+			"pointers in %.3f ms\n", count, num_dispatch_pointers,
+			(piglit_time_get_nano() - start) / 1000000.0);
+	}
+}
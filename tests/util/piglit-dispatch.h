@@ -43,6 +43,11 @@
  * You may also translate a function name to a function pointer at run
  * time by calling piglit_dispatch_resolve_function().
  *
+ * Instead of resolving each function on its first call, all of them may
+ * be resolved at once by calling piglit_dispatch_resolve_all() once the
+ * context is created.  piglit_dispatch_default_init() does so if the
+ * PIGLIT_DISPATCH_EAGER environment variable is true.
+ *
  * The dispatch mechanism must be initialized before its first use.
  * The initialization function, piglit_dispatch_init(), allows the
  * caller to specify which API is in use, how to look up function
@@ -158,6 +163,9 @@ void piglit_dispatch_init(piglit_dispatch_api api,
 piglit_dispatch_function_ptr
 piglit_dispatch_resolve_function(const char *name);
 
+void
+piglit_dispatch_resolve_all(void);
+
 #include "piglit-dispatch-gen.h"
 
 void piglit_dispatch_default_init(piglit_dispatch_api api);
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <setjmp.h>
 
 #include "piglit-util-gl.h"
 #include "piglit-framework-gl/piglit_gl_framework.h"
@@ -215,10 +216,14 @@ void
 piglit_gl_test_run(int argc, char *argv[],
 		   const struct piglit_gl_test_config *config)
 {
+	int64_t start;
+
 	piglit_width = config->window_width;
 	piglit_height = config->window_height;
 
+	start = piglit_time_get_nano();
 	gl_fw = piglit_gl_framework_factory(config);
+	piglit_add_context_creation_time(piglit_time_get_nano() - start);
 	if (gl_fw == NULL) {
 		printf("piglit: error: failed to create "
 		       "piglit_gl_framework\n");
@@ -230,6 +235,61 @@ piglit_gl_test_run(int argc, char *argv[],
 	assert(false);
 }
 
+static jmp_buf module_jmp;
+static enum piglit_result module_result;
+
+static void
+module_report_result(enum piglit_result result)
+{
+	module_result = result;
+	longjmp(module_jmp, 1);
+}
+
+enum piglit_result
+piglit_gl_test_run_module(piglit_gl_test_module_config_func config_func,
+			  int argc, char *argv[])
+{
+	static struct piglit_gl_test_config config;
+	static int64_t start;
+
+	/* Undo the command line options and resource accounting of the
+	 * previous test.
+	 */
+	piglit_reset_resource_usage();
+	piglit_automatic = 0;
+	piglit_use_fbo = false;
+	piglit_dump_png = false;
+	piglit_khr_no_error = false;
+	piglit_winsys_fbo = 0;
+
+	piglit_report_result_handler = module_report_result;
+
+	if (setjmp(module_jmp) == 0) {
+		config_func(&argc, argv, &config);
+
+		piglit_width = config.window_width;
+		piglit_height = config.window_height;
+
+		start = piglit_time_get_nano();
+		gl_fw = piglit_gl_framework_factory(&config);
+		piglit_add_context_creation_time(piglit_time_get_nano() -
+						 start);
+		if (gl_fw == NULL) {
+			printf("piglit: error: failed to create "
+			       "piglit_gl_framework\n");
+			piglit_report_result(PIGLIT_FAIL);
+		}
+
+		gl_fw->run_test(gl_fw, argc, argv);
+		assert(false);
+	}
+
+	destroy();
+	piglit_report_result_handler = NULL;
+
+	return module_result;
+}
+
 void
 piglit_post_redisplay(void)
 {
@@ -312,6 +372,31 @@ piglit_destroy_dma_buf(struct piglit_dma_buf *buf)
 		gl_fw->destroy_dma_buf(buf);
 }
 
+struct piglit_shared_context *
+piglit_create_shared_context(void)
+{
+	if (!gl_fw->create_shared_context)
+		return NULL;
+
+	return gl_fw->create_shared_context(gl_fw);
+}
+
+bool
+piglit_make_shared_context_current(struct piglit_shared_context *ctx)
+{
+	if (!gl_fw->make_shared_context_current)
+		return false;
+
+	return gl_fw->make_shared_context_current(gl_fw, ctx);
+}
+
+void
+piglit_destroy_shared_context(struct piglit_shared_context *ctx)
+{
+	if (ctx && gl_fw->destroy_shared_context)
+		gl_fw->destroy_shared_context(gl_fw, ctx);
+}
+
 size_t
 piglit_get_selected_tests(const char ***selected_subtests)
 {
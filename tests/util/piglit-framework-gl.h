@@ -177,6 +177,18 @@ struct piglit_gl_test_config {
 	 */
 	bool requires_displayed_window;
 
+	/**
+	 * The test may tear down its framework and create a new one in the
+	 * same process, as shader_runner does when consecutive scripts need
+	 * different contexts.
+	 *
+	 * If true, then the waffle frameworks keep the context of a destroyed
+	 * framework in a pool and hand it to a later framework that asks for
+	 * the same config instead of creating a new one. The test is
+	 * responsible for resetting any GL state it depends on.
+	 */
+	bool reuse_contexts;
+
 	/**
 	 * This is called once per test, after the GL context has been created
 	 * and made current but before display() is called.
@@ -249,6 +261,21 @@ void
 piglit_gl_test_run(int argc, char *argv[],
 		   const struct piglit_gl_test_config *config);
 
+/**
+ * Signature of piglit_gl_test_module_config(), which every test defines.
+ */
+typedef void (*piglit_gl_test_module_config_func)(
+	int *argc, char *argv[], struct piglit_gl_test_config *config);
+
+/**
+ * Run a test loaded from its shared module like its main() would, but
+ * return the result instead of exiting. The framework, and so the context,
+ * is destroyed before returning.
+ */
+enum piglit_result
+piglit_gl_test_run_module(piglit_gl_test_module_config_func config_func,
+			  int argc, char *argv[]);
+
 #ifdef __cplusplus
 #  define PIGLIT_EXTERN_C_BEGIN extern "C" {
 #  define PIGLIT_EXTERN_C_END   }
@@ -257,6 +284,11 @@ piglit_gl_test_run(int argc, char *argv[],
 #  define PIGLIT_EXTERN_C_END
 #endif
 
+/**
+ * Define main() of a test, and piglit_gl_test_module_config(), which builds
+ * the config of the test from its command line. The latter is what
+ * piglit-module-runner calls when it runs the test from its shared module.
+ */
 #define PIGLIT_GL_TEST_CONFIG_BEGIN                                          \
                                                                              \
         PIGLIT_EXTERN_C_BEGIN                                                \
@@ -267,6 +299,10 @@ piglit_gl_test_run(int argc, char *argv[],
         enum piglit_result                                                   \
         piglit_display(void);                                                \
                                                                              \
+        void                                                                 \
+        piglit_gl_test_module_config(int *argc_inout, char *argv[],          \
+                                     struct piglit_gl_test_config *out);     \
+                                                                             \
         PIGLIT_EXTERN_C_END                                                  \
                                                                              \
         int                                                                  \
@@ -276,6 +312,20 @@ piglit_gl_test_run(int argc, char *argv[],
                                                                              \
                 piglit_general_init();                                       \
                                                                              \
+                piglit_gl_test_module_config(&argc, argv, &config);          \
+                piglit_gl_test_run(argc, argv, &config);                     \
+                                                                             \
+                assert(false);                                               \
+                return 0;                                                    \
+        }                                                                    \
+                                                                             \
+        void                                                                 \
+        piglit_gl_test_module_config(int *argc_inout, char *argv[],          \
+                                     struct piglit_gl_test_config *out)      \
+        {                                                                    \
+                struct piglit_gl_test_config config;                         \
+                int argc = *argc_inout;                                      \
+                                                                             \
                 piglit_gl_test_config_init(&config);                         \
                                                                              \
                 config.init = piglit_init;                                   \
@@ -290,10 +340,9 @@ piglit_gl_test_run(int argc, char *argv[],
                 }                                                            \
                                                                              \
                 piglit_gl_process_args(&argc, argv, &config);                \
-                piglit_gl_test_run(argc, argv, &config);                     \
                                                                              \
-                assert(false);                                               \
-                return 0;                                                    \
+                *argc_inout = argc;                                          \
+                *out = config;                                               \
         }
 
 extern int piglit_automatic;
@@ -349,4 +398,69 @@ piglit_create_dma_buf(unsigned w, unsigned h, unsigned fourcc,
 void
 piglit_destroy_dma_buf(struct piglit_dma_buf *buf);
 
+struct piglit_shared_context;
+
+/**
+ * Create a context that shares objects with the test's context, for use on
+ * another thread. Return NULL if the framework cannot create shared
+ * contexts, in which case the test should skip.
+ */
+struct piglit_shared_context *
+piglit_create_shared_context(void);
+
+/**
+ * Make the shared context current on the calling thread. Passing NULL
+ * releases the calling thread's current context. A shared context may be
+ * current on only one thread at a time.
+ */
+bool
+piglit_make_shared_context_current(struct piglit_shared_context *ctx);
+
+/**
+ * Destroy a shared context. It must not be current on any thread. If the
+ * given pointer (ctx) is NULL no action is taken.
+ */
+void
+piglit_destroy_shared_context(struct piglit_shared_context *ctx);
+
+struct piglit_worker_pool;
+
+/**
+ * A job run by a worker of a piglit_worker_pool. Return false on failure.
+ */
+typedef bool (*piglit_worker_func)(unsigned worker, void *data);
+
+/**
+ * Start @a num_workers threads, each with its own context created with
+ * piglit_create_shared_context(). Return NULL if shared contexts are not
+ * supported.
+ */
+struct piglit_worker_pool *
+piglit_worker_pool_create(unsigned num_workers);
+
+/**
+ * Queue @a func to run on the thread of worker @a worker. Jobs queued on
+ * the same worker run in order, jobs of different workers run concurrently.
+ */
+void
+piglit_worker_pool_submit(struct piglit_worker_pool *pool, unsigned worker,
+			  piglit_worker_func func, void *data);
+
+/**
+ * Wait until all queued jobs have finished. Each worker ends its jobs with a
+ * fence that is waited on here, so that everything the jobs did is
+ * complete when this returns and can be used by the test's context or, by
+ * the next jobs, from any worker. Objects modified by the workers must be
+ * bound again to see the changes. Return false if any job failed since the
+ * last call.
+ */
+bool
+piglit_worker_pool_finish(struct piglit_worker_pool *pool);
+
+/**
+ * Finish all jobs, stop the threads and destroy their contexts.
+ */
+void
+piglit_worker_pool_destroy(struct piglit_worker_pool *pool);
+
 #endif /* PIGLIT_FRAMEWORK_H */
@@ -27,6 +27,30 @@
 #include "piglit_fbo_framework.h"
 #include "piglit_wfl_framework.h"
 
+static GLuint winsys_tex, winsys_depth;
+
+/**
+ * Delete the winsys FBO, so that a pooled context doesn't accumulate one
+ * per test it is reused for.
+ */
+static void
+destroy_winsys_fbo(void)
+{
+#ifndef PIGLIT_USE_OPENGL_ES1
+	if (piglit_winsys_fbo == 0)
+		return;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &piglit_winsys_fbo);
+	glDeleteTextures(1, &winsys_tex);
+	if (winsys_depth)
+		glDeleteTextures(1, &winsys_depth);
+
+	piglit_winsys_fbo = 0;
+	winsys_tex = 0;
+	winsys_depth = 0;
+#endif
+}
 
 static void
 destroy(struct piglit_gl_framework *gl_fw)
@@ -36,6 +60,10 @@ destroy(struct piglit_gl_framework *gl_fw)
 	if (wfl_fw == NULL)
 		return;
 
+	if (wfl_fw->context && gl_fw->test_config &&
+	    gl_fw->test_config->reuse_contexts)
+		destroy_winsys_fbo();
+
 	piglit_wfl_framework_teardown(wfl_fw);
 	free(wfl_fw);
 }
@@ -53,14 +81,12 @@ run_test(struct piglit_gl_framework *gl_fw,
 	piglit_report_result(result);
 }
 
-static bool
-init_gl(struct piglit_wfl_framework *wfl_fw)
+bool
+piglit_fbo_framework_init_winsys_fbo(const struct piglit_gl_test_config *test_config)
 {
 #ifdef PIGLIT_USE_OPENGL_ES1
 	return false;
 #else
-	const struct piglit_gl_test_config *test_config = wfl_fw->gl_fw.test_config;
-
 	GLuint tex, depth = 0;
 	GLenum status;
 
@@ -114,6 +140,9 @@ init_gl(struct piglit_wfl_framework *wfl_fw)
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
+	winsys_tex = tex;
+	winsys_depth = depth;
+
 	status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 	if (status != GL_FRAMEBUFFER_COMPLETE) {
 		fprintf(stderr,
@@ -156,7 +185,7 @@ piglit_fbo_framework_create(const struct piglit_gl_test_config *test_config)
 	if (!ok)
 		goto fail;
 
-	ok = init_gl(wfl_fw);
+	ok = piglit_fbo_framework_init_winsys_fbo(test_config);
 	if (!ok)
 		goto fail;
 
@@ -27,3 +27,10 @@
 
 struct piglit_gl_framework*
 piglit_fbo_framework_create(const struct piglit_gl_test_config *test_config);
+
+/**
+ * Create the FBO that tests render to in FBO mode, sized to piglit_width and
+ * piglit_height, and bind it as piglit_winsys_fbo. A context must be current.
+ */
+bool
+piglit_fbo_framework_init_winsys_fbo(const struct piglit_gl_test_config *test_config);
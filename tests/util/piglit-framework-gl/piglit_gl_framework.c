@@ -31,6 +31,9 @@
 #ifdef PIGLIT_USE_WAFFLE
 #	include "piglit_fbo_framework.h"
 #	include "piglit_winsys_framework.h"
+#	if defined(PIGLIT_HAS_SURFACELESS_EGL) && !defined(PIGLIT_USE_OPENGL_ES1)
+#		include "piglit_surfaceless_framework.h"
+#	endif
 #else
 #	include "piglit_glut_framework.h"
 #endif
@@ -44,6 +47,25 @@ piglit_gl_framework_factory(const struct piglit_gl_test_config *test_config)
 #ifdef PIGLIT_USE_WAFFLE
 	struct piglit_gl_framework *gl_fw = NULL;
 
+#if defined(PIGLIT_HAS_SURFACELESS_EGL) && !defined(PIGLIT_USE_OPENGL_ES1)
+	if (piglit_wfl_framework_choose_platform(test_config) ==
+	    WAFFLE_PLATFORM_SURFACELESS_EGL) {
+		/* There is no window system to display anything, so FBO mode
+		 * is the default.
+		 */
+		if (test_config->requires_displayed_window) {
+			printf("piglit: info: Test requires a displayed window, "
+			       "but PIGLIT_PLATFORM=surfaceless_egl\n");
+			piglit_report_result(PIGLIT_SKIP);
+		}
+
+		piglit_use_fbo = true;
+		gl_fw = piglit_surfaceless_framework_create(test_config);
+		if (gl_fw != NULL)
+			return gl_fw;
+	}
+#endif
+
 	if (piglit_use_fbo && !test_config->requires_displayed_window) {
 		gl_fw = piglit_fbo_framework_create(test_config);
 	}
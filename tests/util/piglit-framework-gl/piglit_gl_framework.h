@@ -78,6 +78,25 @@ struct piglit_gl_framework {
 
 	void
 	(*destroy_dma_buf)(struct piglit_dma_buf *buf);
+
+	/**
+	 * Create a context that shares objects with the test's context, to
+	 * be made current on another thread. May be null.
+	 */
+	struct piglit_shared_context *
+	(*create_shared_context)(struct piglit_gl_framework *gl_fw);
+
+	/**
+	 * Make @a ctx current on the calling thread, or release the current
+	 * context of the calling thread if @a ctx is null.
+	 */
+	bool
+	(*make_shared_context_current)(struct piglit_gl_framework *gl_fw,
+				       struct piglit_shared_context *ctx);
+
+	void
+	(*destroy_shared_context)(struct piglit_gl_framework *gl_fw,
+				  struct piglit_shared_context *ctx);
 };
 
 struct piglit_gl_framework*
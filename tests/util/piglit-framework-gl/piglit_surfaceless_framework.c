@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include "piglit-util-gl.h"
+#include "piglit-util-egl.h"
+#include "piglit-util-waffle.h"
+
+#include "piglit_fbo_framework.h"
+#include "piglit_surfaceless_framework.h"
+#include "piglit_wfl_framework.h"
+
+struct piglit_surfaceless_framework {
+	struct piglit_gl_framework gl_fw;
+
+	EGLDisplay dpy;
+	EGLContext ctx;
+
+	/* What the context was created with, for shared contexts. */
+	EGLenum api;
+	EGLConfig config;
+	EGLint attrib_list[16];
+};
+
+static void
+destroy(struct piglit_gl_framework *gl_fw)
+{
+	struct piglit_surfaceless_framework *sl_fw =
+		(struct piglit_surfaceless_framework *) gl_fw;
+
+	if (sl_fw == NULL)
+		return;
+
+	if (sl_fw->dpy != EGL_NO_DISPLAY) {
+		eglMakeCurrent(sl_fw->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+			       EGL_NO_CONTEXT);
+		if (sl_fw->ctx != EGL_NO_CONTEXT)
+			eglDestroyContext(sl_fw->dpy, sl_fw->ctx);
+		eglTerminate(sl_fw->dpy);
+	}
+
+	piglit_gl_framework_teardown(gl_fw);
+	free(sl_fw);
+}
+
+static void
+run_test(struct piglit_gl_framework *gl_fw,
+         int argc, char *argv[])
+{
+	enum piglit_result result = PIGLIT_PASS;
+
+	if (gl_fw->test_config->init)
+		gl_fw->test_config->init(argc, argv);
+	if (gl_fw->test_config->display)
+		result = gl_fw->test_config->display();
+	piglit_report_result(result);
+}
+
+struct piglit_shared_context {
+	EGLContext ctx;
+};
+
+static struct piglit_shared_context *
+create_shared_context(struct piglit_gl_framework *gl_fw)
+{
+	struct piglit_surfaceless_framework *sl_fw =
+		(struct piglit_surfaceless_framework *) gl_fw;
+	struct piglit_shared_context *ctx;
+	EGLContext egl_ctx;
+
+	egl_ctx = eglCreateContext(sl_fw->dpy, sl_fw->config, sl_fw->ctx,
+				   sl_fw->attrib_list);
+	if (egl_ctx == EGL_NO_CONTEXT)
+		return NULL;
+
+	ctx = malloc(sizeof(*ctx));
+	ctx->ctx = egl_ctx;
+	return ctx;
+}
+
+static bool
+make_shared_context_current(struct piglit_gl_framework *gl_fw,
+			    struct piglit_shared_context *ctx)
+{
+	struct piglit_surfaceless_framework *sl_fw =
+		(struct piglit_surfaceless_framework *) gl_fw;
+
+	/* The bound API is per thread. */
+	if (ctx && !eglBindAPI(sl_fw->api))
+		return false;
+
+	return eglMakeCurrent(sl_fw->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+			      ctx ? ctx->ctx : EGL_NO_CONTEXT);
+}
+
+static void
+destroy_shared_context(struct piglit_gl_framework *gl_fw,
+		       struct piglit_shared_context *ctx)
+{
+	struct piglit_surfaceless_framework *sl_fw =
+		(struct piglit_surfaceless_framework *) gl_fw;
+
+	eglDestroyContext(sl_fw->dpy, ctx->ctx);
+	free(ctx);
+}
+
+/**
+ * Create a context of the given version and profile and make it current
+ * without a surface. Return false, with no context current, if creation
+ * fails or the context is not the one the test asked for.
+ */
+static bool
+make_context_current_singlepass(struct piglit_surfaceless_framework *sl_fw,
+				const struct piglit_gl_test_config *test_config,
+				EGLenum api, int version, EGLint profile_mask)
+{
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	EGLint *attrib_list = sl_fw->attrib_list;
+	EGLint flags = 0;
+	int actual_version;
+	int i = 0;
+
+	if (!piglit_is_egl_extension_supported(sl_fw->dpy,
+					       "EGL_KHR_no_config_context")) {
+		const EGLint config_attribs[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE,
+			api == EGL_OPENGL_API ? EGL_OPENGL_BIT :
+			version >= 30 ? EGL_OPENGL_ES3_BIT_KHR :
+			version >= 20 ? EGL_OPENGL_ES2_BIT :
+			EGL_OPENGL_ES_BIT,
+			EGL_NONE,
+		};
+		EGLint count;
+
+		if (!eglChooseConfig(sl_fw->dpy, config_attribs, &config, 1,
+				     &count) || count == 0)
+			return false;
+	}
+
+	attrib_list[i++] = EGL_CONTEXT_MAJOR_VERSION_KHR;
+	attrib_list[i++] = version / 10;
+	attrib_list[i++] = EGL_CONTEXT_MINOR_VERSION_KHR;
+	attrib_list[i++] = version % 10;
+
+	if (api == EGL_OPENGL_API && version >= 32) {
+		attrib_list[i++] = EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR;
+		attrib_list[i++] = profile_mask;
+	}
+
+	/* See the comment in parse_test_config() of the waffle framework on
+	 * why 3.1 core contexts are forward-compatible.
+	 */
+	if (test_config->require_forward_compatible_context ||
+	    (profile_mask == EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR &&
+	     version == 31))
+		flags |= EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR;
+	if (test_config->require_debug_context)
+		flags |= EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR;
+	if (flags) {
+		attrib_list[i++] = EGL_CONTEXT_FLAGS_KHR;
+		attrib_list[i++] = flags;
+	}
+
+	attrib_list[i++] = EGL_NONE;
+
+	if (!eglBindAPI(api))
+		return false;
+
+	sl_fw->ctx = eglCreateContext(sl_fw->dpy, config, EGL_NO_CONTEXT,
+				      attrib_list);
+	if (sl_fw->ctx == EGL_NO_CONTEXT)
+		return false;
+
+	if (!eglMakeCurrent(sl_fw->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+			    sl_fw->ctx))
+		goto fail;
+
+#ifdef PIGLIT_USE_OPENGL
+	piglit_dispatch_default_init(PIGLIT_DISPATCH_GL);
+#elif defined(PIGLIT_USE_OPENGL_ES2) || defined(PIGLIT_USE_OPENGL_ES3)
+	piglit_dispatch_default_init(PIGLIT_DISPATCH_ES2);
+#else
+#	error
+#endif
+
+	piglit_gl_invalidate_extensions();
+
+	/* A 3.1 context has no profile. Leave contexts whose
+	 * GL_ARB_compatibility doesn't match the requested profile to the
+	 * waffle framework, which knows how to work around them.
+	 */
+	actual_version = piglit_get_gl_version();
+	if (actual_version < version)
+		goto fail;
+	if (api == EGL_OPENGL_API && actual_version == 31 &&
+	    piglit_is_extension_supported("GL_ARB_compatibility") !=
+	    (profile_mask == EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR))
+		goto fail;
+
+	sl_fw->api = api;
+	sl_fw->config = config;
+
+	return true;
+
+fail:
+	eglMakeCurrent(sl_fw->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+		       EGL_NO_CONTEXT);
+	eglDestroyContext(sl_fw->dpy, sl_fw->ctx);
+	sl_fw->ctx = EGL_NO_CONTEXT;
+	piglit_gl_invalidate_extensions();
+	return false;
+}
+
+static bool
+make_context_current(struct piglit_surfaceless_framework *sl_fw,
+		     const struct piglit_gl_test_config *test_config)
+{
+#if defined(PIGLIT_USE_OPENGL)
+	if (test_config->supports_gl_core_version &&
+	    make_context_current_singlepass(sl_fw, test_config, EGL_OPENGL_API,
+			test_config->supports_gl_core_version,
+			EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR)) {
+		piglit_is_core_profile = true;
+		return true;
+	}
+
+	piglit_is_core_profile = false;
+
+	return test_config->supports_gl_compat_version &&
+	       make_context_current_singlepass(sl_fw, test_config,
+			EGL_OPENGL_API,
+			test_config->supports_gl_compat_version,
+			EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR);
+#else
+	return make_context_current_singlepass(sl_fw, test_config,
+			EGL_OPENGL_ES_API,
+			test_config->supports_gl_es_version, 0);
+#endif
+}
+
+struct piglit_gl_framework*
+piglit_surfaceless_framework_create(const struct piglit_gl_test_config *test_config)
+{
+	struct piglit_surfaceless_framework *sl_fw;
+	struct piglit_gl_framework *gl_fw;
+
+	/* Let the FBO framework report that multisampling is unsupported. */
+	if (test_config->window_samples > 1)
+		return NULL;
+
+	sl_fw = calloc(1, sizeof(*sl_fw));
+	gl_fw = &sl_fw->gl_fw;
+	sl_fw->dpy = EGL_NO_DISPLAY;
+	sl_fw->ctx = EGL_NO_CONTEXT;
+
+	if (!piglit_gl_framework_init(gl_fw, test_config))
+		goto fail;
+
+	/* GL functions are still resolved through waffle. */
+	piglit_wfl_framework_init_waffle(WAFFLE_PLATFORM_SURFACELESS_EGL);
+
+	sl_fw->dpy = piglit_egl_get_default_display(EGL_PLATFORM_SURFACELESS_MESA);
+	if (sl_fw->dpy == EGL_NO_DISPLAY)
+		goto fail;
+
+	if (!eglInitialize(sl_fw->dpy, NULL, NULL)) {
+		sl_fw->dpy = EGL_NO_DISPLAY;
+		goto fail;
+	}
+
+	if (!piglit_is_egl_extension_supported(sl_fw->dpy,
+					       "EGL_KHR_surfaceless_context") ||
+	    !piglit_is_egl_extension_supported(sl_fw->dpy,
+					       "EGL_KHR_create_context"))
+		goto fail;
+
+	if (!make_context_current(sl_fw, test_config))
+		goto fail;
+
+	if (!piglit_fbo_framework_init_winsys_fbo(test_config))
+		goto fail;
+
+	gl_fw->destroy = destroy;
+	gl_fw->run_test = run_test;
+	gl_fw->create_shared_context = create_shared_context;
+	gl_fw->make_shared_context_current = make_shared_context_current;
+	gl_fw->destroy_shared_context = destroy_shared_context;
+
+	return gl_fw;
+
+fail:
+	destroy(gl_fw);
+	return NULL;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "piglit_gl_framework.h"
+
+/**
+ * Create a framework for PIGLIT_PLATFORM=surfaceless_egl that renders to an
+ * FBO in a context made current without any surface.
+ *
+ * The context is created with EGL directly on an EGL_MESA_platform_surfaceless
+ * display and made current with EGL_KHR_surfaceless_context, so no EGL config
+ * or window is chosen or created. Returns NULL if the display lacks any of
+ * the required extensions or the context doesn't satisfy the test config, in
+ * which case the caller should fall back to the waffle based FBO framework.
+ */
+struct piglit_gl_framework*
+piglit_surfaceless_framework_create(const struct piglit_gl_test_config *test_config);
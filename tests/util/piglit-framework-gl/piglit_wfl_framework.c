@@ -22,6 +22,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "piglit-util-gl.h"
 #include "piglit-util-waffle.h"
@@ -111,6 +113,16 @@ piglit_wfl_framework_choose_platform(const struct piglit_gl_test_config *test_co
 #endif
 	}
 
+	else if (streq(env, "surfaceless_egl")) {
+#ifdef PIGLIT_HAS_SURFACELESS_EGL
+		return WAFFLE_PLATFORM_SURFACELESS_EGL;
+#else
+		fprintf(stderr, "environment var PIGLIT_PLATFORM=surfaceless_egl, "
+		        "but piglit was built without surfaceless EGL support\n");
+		piglit_report_result(PIGLIT_FAIL);
+#endif
+	}
+
 	else if (strcmp(env, "wgl") == 0) {
 #ifdef PIGLIT_HAS_WGL
 		return WAFFLE_PLATFORM_WGL;
@@ -447,6 +459,150 @@ special_case_gl31(struct piglit_wfl_framework *wfl_fw,
 			partial_config_attrib_list);
 }
 
+/**
+ * The maximum number of idle contexts kept by the context pool.
+ */
+#define CONTEXT_POOL_SIZE 4
+
+/**
+ * Contexts of destroyed frameworks whose test config set reuse_contexts.
+ *
+ * Each entry owns the config, context and window of one framework, keyed by
+ * the config attributes and the window size they were created with. They all
+ * belong to pooled_display, which is kept connected for the lifetime of the
+ * process once a context has been pooled.
+ */
+static struct context_pool_entry {
+	int32_t *attrib_list;
+	int window_width;
+	int window_height;
+	struct waffle_config *config;
+	struct waffle_context *context;
+	struct waffle_window *window;
+} context_pool[CONTEXT_POOL_SIZE];
+
+static unsigned context_pool_count;
+static struct waffle_display *pooled_display;
+
+static struct {
+	unsigned created;
+	unsigned reused;
+	int64_t create_time_ns;
+} context_pool_stats;
+
+static bool
+attrib_lists_equal(const int32_t *a, const int32_t *b)
+{
+	int i;
+
+	for (i = 0; a[i] != 0 || b[i] != 0; i += 2) {
+		if (a[i] != b[i] || a[i + 1] != b[i + 1])
+			return false;
+	}
+
+	return true;
+}
+
+static void
+print_context_pool_stats(void)
+{
+	double create_ms = 0.0;
+
+	if (context_pool_stats.created > 0) {
+		create_ms = context_pool_stats.create_time_ns / 1000000.0 /
+			    context_pool_stats.created;
+	}
+
+	fprintf(stderr, "piglit: context pool: %u created, %u reused, "
+		"%.3f ms per creation, ~%.3f ms saved\n",
+		context_pool_stats.created, context_pool_stats.reused,
+		create_ms, create_ms * context_pool_stats.reused);
+}
+
+static void
+destroy_context_pool_entry(struct context_pool_entry *entry)
+{
+	waffle_window_destroy(entry->window);
+	waffle_context_destroy(entry->context);
+	waffle_config_destroy(entry->config);
+	free(entry->attrib_list);
+}
+
+/**
+ * Hand the config, context and window of the framework over to the pool. If
+ * the pool is full, the least recently pooled context is destroyed.
+ */
+static void
+put_pooled_context(struct piglit_wfl_framework *wfl_fw)
+{
+	const struct piglit_gl_test_config *test_config = wfl_fw->gl_fw.test_config;
+	struct context_pool_entry *entry;
+
+	if (pooled_display == NULL &&
+	    piglit_env_var_as_boolean("PIGLIT_CONTEXT_POOL_STATS", false))
+		atexit(print_context_pool_stats);
+
+	pooled_display = wfl_fw->display;
+
+	if (context_pool_count == CONTEXT_POOL_SIZE) {
+		destroy_context_pool_entry(&context_pool[0]);
+		memmove(&context_pool[0], &context_pool[1],
+			(CONTEXT_POOL_SIZE - 1) * sizeof(context_pool[0]));
+		context_pool_count--;
+	}
+
+	entry = &context_pool[context_pool_count++];
+	entry->attrib_list = wfl_fw->config_attrib_list;
+	entry->window_width = test_config->window_width;
+	entry->window_height = test_config->window_height;
+	entry->config = wfl_fw->config;
+	entry->context = wfl_fw->context;
+	entry->window = wfl_fw->window;
+
+	wfl_fw->config_attrib_list = NULL;
+	wfl_fw->config = NULL;
+	wfl_fw->context = NULL;
+	wfl_fw->window = NULL;
+}
+
+/**
+ * If the pool has a context created with the framework's config attributes
+ * and the window size of the test config, move it to the framework and
+ * return true.
+ */
+static bool
+take_pooled_context(struct piglit_wfl_framework *wfl_fw,
+		    const struct piglit_gl_test_config *test_config)
+{
+	unsigned i;
+
+	if (wfl_fw->display != pooled_display)
+		return false;
+
+	for (i = 0; i < context_pool_count; i++) {
+		struct context_pool_entry *entry = &context_pool[i];
+
+		if (entry->window_width != test_config->window_width ||
+		    entry->window_height != test_config->window_height ||
+		    !attrib_lists_equal(entry->attrib_list,
+					wfl_fw->config_attrib_list))
+			continue;
+
+		wfl_fw->config = entry->config;
+		wfl_fw->context = entry->context;
+		wfl_fw->window = entry->window;
+		free(entry->attrib_list);
+
+		memmove(entry, entry + 1,
+			(context_pool_count - i - 1) * sizeof(*entry));
+		context_pool_count--;
+		context_pool_stats.reused++;
+		return true;
+	}
+
+	return false;
+}
+
 static bool
 make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
                                 const struct piglit_gl_test_config *test_config,
@@ -455,6 +611,7 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 {
 	bool ok;
 	int32_t *attrib_list = NULL;
+	int64_t create_start;
 	char ctx_desc[1024];
 
 	assert(wfl_fw->config == NULL);
@@ -464,8 +621,16 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 	parse_test_config(test_config, flavor, ctx_desc, sizeof(ctx_desc),
 			  partial_config_attrib_list, &attrib_list);
 	assert(attrib_list);
+	free(wfl_fw->config_attrib_list);
+	wfl_fw->config_attrib_list = attrib_list;
+
+	if (test_config->reuse_contexts &&
+	    take_pooled_context(wfl_fw, test_config))
+		goto make_current;
+
+	create_start = piglit_time_get_nano();
+
 	wfl_fw->config = waffle_config_choose(wfl_fw->display, attrib_list);
-	free(attrib_list);
 	if (!wfl_fw->config) {
 		wfl_log_error("waffle_config_choose");
 		fprintf(stderr, "piglit: error: Failed to create "
@@ -485,6 +650,10 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 	                                           test_config->window_width,
 	                                           test_config->window_height);
 
+	context_pool_stats.created++;
+	context_pool_stats.create_time_ns += piglit_time_get_nano() - create_start;
+
+make_current:
 	wfl_checked_make_current(wfl_fw->display,
 	                         wfl_fw->window,
 	                         wfl_fw->context);
@@ -509,6 +678,7 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 		goto fail;
 
 	piglit_gl_invalidate_extensions();
+
 	return true;
 
 fail:
@@ -594,11 +764,70 @@ make_context_current(struct piglit_wfl_framework *wfl_fw,
 }
 
 
-bool
-piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
-                          const struct piglit_gl_test_config *test_config,
-                          int32_t platform,
-                          const int32_t partial_config_attrib_list[])
+/**
+ * A context in the share group of the framework's context. Each one has its
+ * own hidden window, because EGL lets a surface be current to only one
+ * context at a time.
+ */
+struct piglit_shared_context {
+	struct waffle_context *context;
+	struct waffle_window *window;
+};
+
+static struct piglit_shared_context *
+create_shared_context(struct piglit_gl_framework *gl_fw)
+{
+	struct piglit_wfl_framework *wfl_fw = piglit_wfl_framework(gl_fw);
+	struct piglit_shared_context *ctx = calloc(1, sizeof(*ctx));
+
+	ctx->context = waffle_context_create(wfl_fw->config, wfl_fw->context);
+	if (!ctx->context) {
+		wfl_log_error("waffle_context_create");
+		goto fail;
+	}
+
+	ctx->window = waffle_window_create(wfl_fw->config, 1, 1);
+	if (!ctx->window) {
+		wfl_log_error("waffle_window_create");
+		goto fail;
+	}
+
+	return ctx;
+
+fail:
+	waffle_context_destroy(ctx->context);
+	free(ctx);
+	return NULL;
+}
+
+static bool
+make_shared_context_current(struct piglit_gl_framework *gl_fw,
+			    struct piglit_shared_context *ctx)
+{
+	struct piglit_wfl_framework *wfl_fw = piglit_wfl_framework(gl_fw);
+
+	if (!ctx)
+		return waffle_make_current(wfl_fw->display, NULL, NULL);
+
+	if (!waffle_make_current(wfl_fw->display, ctx->window, ctx->context)) {
+		wfl_log_error("waffle_make_current");
+		return false;
+	}
+
+	return true;
+}
+
+static void
+destroy_shared_context(struct piglit_gl_framework *gl_fw,
+		       struct piglit_shared_context *ctx)
+{
+	waffle_window_destroy(ctx->window);
+	waffle_context_destroy(ctx->context);
+	free(ctx);
+}
+
+void
+piglit_wfl_framework_init_waffle(int32_t platform)
 {
 	static bool is_waffle_initialized = false;
 	static int32_t initialized_platform = 0;
@@ -617,6 +846,15 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 		is_waffle_initialized = true;
 		initialized_platform = platform;
 	}
+}
+
+bool
+piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
+                          const struct piglit_gl_test_config *test_config,
+                          int32_t platform,
+                          const int32_t partial_config_attrib_list[])
+{
+	piglit_wfl_framework_init_waffle(platform);
 
 	if (!piglit_gl_framework_init(&wfl_fw->gl_fw, test_config)) {
 		piglit_wfl_framework_teardown(wfl_fw);
@@ -624,20 +862,39 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 	}
 
 	wfl_fw->platform = platform;
-	wfl_fw->display = wfl_checked_display_connect(NULL);
+	if (pooled_display)
+		wfl_fw->display = pooled_display;
+	else
+		wfl_fw->display = wfl_checked_display_connect(NULL);
+
 	make_context_current(wfl_fw, test_config, partial_config_attrib_list);
 
+	wfl_fw->gl_fw.create_shared_context = create_shared_context;
+	wfl_fw->gl_fw.make_shared_context_current = make_shared_context_current;
+	wfl_fw->gl_fw.destroy_shared_context = destroy_shared_context;
+
 	return true;
 }
 
 void
 piglit_wfl_framework_teardown(struct piglit_wfl_framework *wfl_fw)
 {
+	const struct piglit_gl_test_config *test_config = wfl_fw->gl_fw.test_config;
+
 	waffle_make_current(wfl_fw->display, NULL, NULL);
-	waffle_window_destroy(wfl_fw->window);
-	waffle_context_destroy(wfl_fw->context);
-	waffle_config_destroy(wfl_fw->config);
-	waffle_display_disconnect(wfl_fw->display);
+
+	if (test_config && test_config->reuse_contexts && wfl_fw->context) {
+		put_pooled_context(wfl_fw);
+	} else {
+		waffle_window_destroy(wfl_fw->window);
+		waffle_context_destroy(wfl_fw->context);
+		waffle_config_destroy(wfl_fw->config);
+		if (wfl_fw->display != pooled_display)
+			waffle_display_disconnect(wfl_fw->display);
+	}
+
+	free(wfl_fw->config_attrib_list);
+	wfl_fw->config_attrib_list = NULL;
 
 	piglit_gl_framework_teardown(&wfl_fw->gl_fw);
 }
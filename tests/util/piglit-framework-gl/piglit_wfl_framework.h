@@ -39,6 +39,12 @@ struct piglit_wfl_framework {
 	struct waffle_config *config;
 	struct waffle_context *context;
 	struct waffle_window *window;
+
+	/**
+	 * The attributes the config was chosen with. Used as the key of the
+	 * context pool.
+	 */
+	int32_t *config_attrib_list;
 };
 
 /**
@@ -47,6 +53,15 @@ struct piglit_wfl_framework {
 struct piglit_wfl_framework*
 piglit_wfl_framework(struct piglit_gl_framework *gl_fw);
 
+/**
+ * Initialize waffle for @a platform. Waffle can be initialized only once per
+ * process, so later calls must pass the same platform and do nothing.
+ *
+ * @param platform must be one of WAFFLE_PLATFORM_*.
+ */
+void
+piglit_wfl_framework_init_waffle(int32_t platform);
+
 /**
  * @param platform must be one of WAFFLE_PLATFORM_*.
  */
@@ -190,6 +190,12 @@ piglit_winsys_framework_factory(const struct piglit_gl_test_config *test_config)
 		return piglit_wgl_framework_create(test_config);
 #endif
 
+#ifdef PIGLIT_HAS_SURFACELESS_EGL
+	case WAFFLE_PLATFORM_SURFACELESS_EGL:
+		/* There are no windows, only the FBO framework works. */
+		return NULL;
+#endif
+
 	default:
 		assert(0);
 		return NULL;
@@ -35,6 +35,17 @@
  */
 static const char **gl_extensions = NULL;
 
+/**
+ * A hash set of the strings in gl_extensions, using open addressing with
+ * linear probing. The size is a power of two and empty slots are NULL.
+ *
+ * Drivers expose hundreds of extensions, and some tests check for
+ * extensions in loops, so piglit_is_extension_supported() shouldn't scan
+ * the whole list each time.
+ */
+static const char **gl_extension_set = NULL;
+static unsigned gl_extension_set_mask;
+
 static const float color_wheel[4][4] = {
 	{1, 0, 0, 1}, /* red */
 	{0, 1, 0, 1}, /* green */
@@ -102,6 +113,55 @@ static const char** gl_extension_array_from_getstringi()
 	return (const char**) strings;
 }
 
+/** FNV-1a hash of an extension name */
+static uint32_t hash_extension_name(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name != '\0') {
+		hash ^= (uint8_t) *name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Return the slot of gl_extension_set that holds \p name, or the empty
+ * slot where it would be inserted.
+ */
+static unsigned find_extension_slot(const char *name)
+{
+	unsigned slot = hash_extension_name(name) & gl_extension_set_mask;
+
+	while (gl_extension_set[slot] != NULL &&
+	       strcmp(gl_extension_set[slot], name) != 0) {
+		slot = (slot + 1) & gl_extension_set_mask;
+	}
+	return slot;
+}
+
+static void build_extension_set(void)
+{
+	unsigned count, size = 16;
+	unsigned i;
+
+	for (count = 0; gl_extensions[count] != NULL; count++)
+		;
+
+	/* Keep the load factor at or below 1/2. */
+	while (size < count * 2)
+		size *= 2;
+
+	gl_extension_set = calloc(size, sizeof(*gl_extension_set));
+	assert(gl_extension_set != NULL);
+	gl_extension_set_mask = size - 1;
+
+	for (i = 0; i < count; i++) {
+		gl_extension_set[find_extension_slot(gl_extensions[i])] =
+			gl_extensions[i];
+	}
+}
+
 static void initialize_piglit_extension_support(void)
 {
 	if (gl_extensions != NULL) {
@@ -113,6 +173,8 @@ static void initialize_piglit_extension_support(void)
 	} else {
 		gl_extensions = gl_extension_array_from_getstringi();
 	}
+
+	build_extension_set();
 }
 
 void piglit_gl_invalidate_extensions()
@@ -120,13 +182,19 @@ void piglit_gl_invalidate_extensions()
 	if (gl_extensions != NULL) {
 		free(gl_extensions);
 		gl_extensions = NULL;
+		free(gl_extension_set);
+		gl_extension_set = NULL;
 	}
 }
 
 bool piglit_is_extension_supported(const char *name)
 {
 	initialize_piglit_extension_support();
-	return piglit_is_extension_in_array(gl_extensions, name);
+
+	if (name[0] == '\0')
+		return false;
+
+	return gl_extension_set[find_extension_slot(name)] != NULL;
 }
 
 void piglit_require_gl_version(int required_version_times_10)
@@ -54,6 +54,12 @@
 #define USE_SETRLIMIT
 #endif
 
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_SYS_RESOURCE_H) && defined(HAVE_GETRUSAGE)
+#include <sys/time.h>
+#include <sys/resource.h>
+#define USE_GETRUSAGE
+#endif
+
 #if defined(HAVE_FCNTL_H) && defined(HAVE_SYS_STAT_H) && defined(HAVE_SYS_TYPES_H) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
 # include <sys/types.h>
 # include <sys/stat.h>
@@ -222,6 +228,108 @@ piglit_result_to_string(enum piglit_result result)
         return "Unknown result";
 }
 
+void (*piglit_report_result_handler)(enum piglit_result result);
+
+/* When piglit_general_init() was called, and the total time spent creating
+ * GL contexts since, for the resource usage report.
+ */
+static int64_t general_init_time = -1;
+static int64_t context_creation_time;
+
+#ifdef USE_GETRUSAGE
+/* The usage when piglit_reset_resource_usage() was last called, which is
+ * subtracted from the reported usage. Zero for a test that has the process
+ * to itself.
+ */
+static struct rusage reset_usage;
+#endif
+
+static void
+reset_times(void)
+{
+	general_init_time = piglit_time_get_nano();
+	context_creation_time = 0;
+}
+
+void
+piglit_reset_resource_usage(void)
+{
+#ifdef USE_GETRUSAGE
+	if (getrusage(RUSAGE_SELF, &reset_usage) != 0)
+		memset(&reset_usage, 0, sizeof(reset_usage));
+#endif
+	reset_times();
+}
+
+void
+piglit_add_context_creation_time(int64_t nsec)
+{
+	context_creation_time += nsec;
+}
+
+/**
+ * Print the resources used by the test so far, like
+ *
+ *	PIGLIT: {"rusage": {"maxrss_kb": 45312, "utime": 0.052, ...}}
+ *
+ * CPU and wall times are in seconds. The values are totals since the test
+ * started, so the last line printed is the usage of the whole test. When
+ * several tests run in one process, the usage before
+ * piglit_reset_resource_usage() is subtracted, except from maxrss_kb: it is
+ * the high-water mark of the whole process and can't be reset.
+ */
+static void
+report_resource_usage(void)
+{
+	char buf[512];
+	int len = 0;
+
+#ifdef USE_GETRUSAGE
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		long maxrss_kb = usage.ru_maxrss;
+
+#ifdef __APPLE__
+		/* Bytes instead of kilobytes. */
+		maxrss_kb /= 1024;
+#endif
+
+		len += snprintf(buf + len, sizeof(buf) - len,
+				"\"maxrss_kb\": %ld, "
+				"\"utime\": %.6f, \"stime\": %.6f, "
+				"\"minflt\": %ld, \"majflt\": %ld, "
+				"\"nvcsw\": %ld, \"nivcsw\": %ld, ",
+				maxrss_kb,
+				(usage.ru_utime.tv_sec -
+				 reset_usage.ru_utime.tv_sec) +
+				(usage.ru_utime.tv_usec -
+				 reset_usage.ru_utime.tv_usec) / 1e6,
+				(usage.ru_stime.tv_sec -
+				 reset_usage.ru_stime.tv_sec) +
+				(usage.ru_stime.tv_usec -
+				 reset_usage.ru_stime.tv_usec) / 1e6,
+				usage.ru_minflt - reset_usage.ru_minflt,
+				usage.ru_majflt - reset_usage.ru_majflt,
+				usage.ru_nvcsw - reset_usage.ru_nvcsw,
+				usage.ru_nivcsw - reset_usage.ru_nivcsw);
+	}
+#endif
+
+	if (general_init_time >= 0) {
+		len += snprintf(buf + len, sizeof(buf) - len,
+				"\"wall_time\": %.6f, ",
+				(piglit_time_get_nano() - general_init_time) /
+				1e9);
+	}
+
+	len += snprintf(buf + len, sizeof(buf) - len,
+			"\"context_time\": %.6f",
+			context_creation_time / 1e9);
+
+	printf("PIGLIT: {\"rusage\": {%s}}\n", buf);
+}
+
 void
 piglit_report_result(enum piglit_result result)
 {
@@ -235,9 +343,18 @@ piglit_report_result(enum piglit_result result)
 
 	fflush(stderr);
 
+	report_resource_usage();
 	printf("PIGLIT: {\"result\": \"%s\" }\n", result_str);
 	fflush(stdout);
 
+	if (piglit_report_result_handler) {
+#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+		/* The next test reports its own result. */
+		pthread_mutex_unlock(&result_lock);
+#endif
+		piglit_report_result_handler(result);
+	}
+
 	switch(result) {
 	case PIGLIT_PASS:
 	case PIGLIT_SKIP:
@@ -271,6 +388,13 @@ piglit_set_timeout(double seconds, enum piglit_result timeout_result)
 		.it_value = { .tv_sec = sec, .tv_nsec = (seconds - sec) * 1e9 },
 	};
 	timer_t timerid;
+
+	/* The timer thread can't return to the module runner. */
+	if (piglit_report_result_handler) {
+		piglit_logi("Timeouts are not supported in the module runner");
+		return;
+	}
+
 	timer_create(CLOCK_MONOTONIC, &sev, &timerid);
 	timer_settime(timerid, 0, &spec, NULL);
 #else
@@ -286,6 +410,7 @@ piglit_report_subtest_result(enum piglit_result result, const char *format, ...)
 
 	va_start(ap, format);
 
+	report_resource_usage();
 	printf("PIGLIT: {\"subtest\": {\"");
 	vprintf(format, ap);
 	printf("\" : \"%s\"}}\n", result_str);
@@ -345,6 +470,12 @@ piglit_general_init(void)
 {
 	piglit_disable_error_message_boxes();
 	piglit_set_line_buffering();
+
+	/* shader_runner calls main() again to recreate its context, keep
+	 * accounting from the first call.
+	 */
+	if (general_init_time < 0)
+		reset_times();
 }
 
 
@@ -411,7 +411,29 @@ int piglit_find_line(const char *program, int position);
 void piglit_merge_result(enum piglit_result *all, enum piglit_result subtest);
 const char * piglit_result_to_string(enum piglit_result result);
 NORETURN void piglit_report_result(enum piglit_result result);
+
+/**
+ * If set, piglit_report_result() calls this after printing the result
+ * instead of exiting. It must not return, piglit-module-runner uses it to
+ * longjmp() back to the runner when a test is done. Timeouts are not
+ * supported while it is set.
+ */
+extern void (*piglit_report_result_handler)(enum piglit_result result);
+
 void piglit_set_timeout(double seconds, enum piglit_result timeout_result);
+
+/**
+ * Account time spent creating a GL context in the resource usage that
+ * piglit_report_result() and piglit_report_subtest_result() print.
+ */
+void piglit_add_context_creation_time(int64_t nsec);
+
+/**
+ * Restart the resource usage accounting, for runners that run several tests
+ * in one process. The maximum resident set size stays the high-water mark of
+ * the whole process.
+ */
+void piglit_reset_resource_usage(void);
 void piglit_report_subtest_result(enum piglit_result result,
 				  const char *format, ...) PRINTFLIKE(2, 3);
 
@@ -0,0 +1,291 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-worker-pool.c
+ *
+ * Threads with contexts that share objects with the test's context, to run
+ * parts of a test concurrently.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "piglit-util-gl.h"
+
+struct job {
+	piglit_worker_func func;
+	void *data;
+	struct job *next;
+};
+
+struct worker {
+	struct piglit_worker_pool *pool;
+	unsigned index;
+	pthread_t thread;
+	struct piglit_shared_context *ctx;
+
+	/* Protected by the pool's mutex. */
+	struct job *head, *tail;
+	bool busy;
+	bool failed;
+	GLsync fence;
+};
+
+struct piglit_worker_pool {
+	pthread_mutex_t mutex;
+	/* Signalled when jobs are queued or the pool is destroyed. */
+	pthread_cond_t work_cond;
+	/* Signalled when a worker runs out of jobs. */
+	pthread_cond_t idle_cond;
+	bool started;
+	bool quit;
+	bool use_fences;
+
+	unsigned num_workers;
+	struct worker *workers;
+};
+
+/**
+ * Mark the end of a batch of jobs. Without fences, wait for the commands
+ * to complete here.
+ */
+static GLsync
+end_batch(struct piglit_worker_pool *pool)
+{
+	GLsync fence;
+
+	if (!pool->use_fences) {
+		glFinish();
+		return NULL;
+	}
+
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+	return fence;
+}
+
+static void *
+worker_main(void *arg)
+{
+	struct worker *w = arg;
+	struct piglit_worker_pool *pool = w->pool;
+	GLsync fence;
+
+	if (!piglit_make_shared_context_current(w->ctx)) {
+		fprintf(stderr, "worker %u: failed to make its context "
+			"current\n", w->index);
+		piglit_report_result(PIGLIT_FAIL);
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		struct job *job = w->head;
+		bool ok;
+
+		if (!job) {
+			if (w->busy) {
+				pthread_mutex_unlock(&pool->mutex);
+				fence = end_batch(pool);
+				pthread_mutex_lock(&pool->mutex);
+
+				/* The new fence also covers the commands of
+				 * the previous batch.
+				 */
+				if (w->fence)
+					glDeleteSync(w->fence);
+				w->fence = fence;
+
+				/* Jobs submitted while the mutex was
+				 * released aren't covered by the fence, end
+				 * another batch for them first.
+				 */
+				if (!w->head) {
+					w->busy = false;
+					pthread_cond_broadcast(
+						&pool->idle_cond);
+				}
+				continue;
+			}
+			if (pool->quit)
+				break;
+			pthread_cond_wait(&pool->work_cond, &pool->mutex);
+			continue;
+		}
+
+		w->head = job->next;
+		if (!w->head)
+			w->tail = NULL;
+		pthread_mutex_unlock(&pool->mutex);
+
+		ok = job->func(w->index, job->data);
+		free(job);
+
+		pthread_mutex_lock(&pool->mutex);
+		if (!ok)
+			w->failed = true;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	piglit_make_shared_context_current(NULL);
+	return NULL;
+}
+
+struct piglit_worker_pool *
+piglit_worker_pool_create(unsigned num_workers)
+{
+	struct piglit_worker_pool *pool = calloc(1, sizeof(*pool));
+	unsigned i;
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work_cond, NULL);
+	pthread_cond_init(&pool->idle_cond, NULL);
+
+	if (piglit_is_gles())
+		pool->use_fences = piglit_get_gl_version() >= 30;
+	else
+		pool->use_fences = piglit_get_gl_version() >= 32 ||
+			piglit_is_extension_supported("GL_ARB_sync");
+
+	pool->workers = calloc(num_workers, sizeof(*pool->workers));
+
+	/* The contexts are created up front, so that a missing feature is
+	 * found before any thread starts.
+	 */
+	for (i = 0; i < num_workers; i++) {
+		struct worker *w = &pool->workers[i];
+
+		w->pool = pool;
+		w->index = i;
+		w->ctx = piglit_create_shared_context();
+		if (!w->ctx) {
+			piglit_worker_pool_destroy(pool);
+			return NULL;
+		}
+		pool->num_workers++;
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		struct worker *w = &pool->workers[i];
+
+		if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+			fprintf(stderr, "Failed to create worker thread\n");
+			piglit_report_result(PIGLIT_FAIL);
+		}
+	}
+	pool->started = true;
+
+	return pool;
+}
+
+void
+piglit_worker_pool_submit(struct piglit_worker_pool *pool, unsigned worker,
+			  piglit_worker_func func, void *data)
+{
+	struct worker *w = &pool->workers[worker % pool->num_workers];
+	struct job *job = malloc(sizeof(*job));
+
+	job->func = func;
+	job->data = data;
+	job->next = NULL;
+
+	pthread_mutex_lock(&pool->mutex);
+	if (w->tail)
+		w->tail->next = job;
+	else
+		w->head = job;
+	w->tail = job;
+	w->busy = true;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+bool
+piglit_worker_pool_finish(struct piglit_worker_pool *pool)
+{
+	GLsync *fences = calloc(pool->num_workers, sizeof(*fences));
+	bool pass = true;
+	unsigned i;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (i = 0; i < pool->num_workers; i++) {
+		struct worker *w = &pool->workers[i];
+
+		while (w->busy)
+			pthread_cond_wait(&pool->idle_cond, &pool->mutex);
+
+		if (w->failed)
+			pass = false;
+		w->failed = false;
+
+		fences[i] = w->fence;
+		w->fence = NULL;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	/* Sync objects are shared, so the fence of a worker can be waited on
+	 * in the test's context. Waiting on the client makes the results
+	 * visible to every context, not just to this one.
+	 */
+	for (i = 0; i < pool->num_workers; i++) {
+		if (!fences[i])
+			continue;
+
+		glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT,
+				 GL_TIMEOUT_IGNORED);
+		glDeleteSync(fences[i]);
+	}
+	free(fences);
+
+	return pass;
+}
+
+void
+piglit_worker_pool_destroy(struct piglit_worker_pool *pool)
+{
+	unsigned i;
+
+	if (!pool)
+		return;
+
+	if (pool->started) {
+		piglit_worker_pool_finish(pool);
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->quit = true;
+		pthread_cond_broadcast(&pool->work_cond);
+		pthread_mutex_unlock(&pool->mutex);
+
+		for (i = 0; i < pool->num_workers; i++)
+			pthread_join(pool->workers[i].thread, NULL);
+	}
+
+	for (i = 0; i < pool->num_workers; i++)
+		piglit_destroy_shared_context(pool->workers[i].ctx);
+
+	pthread_cond_destroy(&pool->idle_cond);
+	pthread_cond_destroy(&pool->work_cond);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->workers);
+	free(pool);
+}
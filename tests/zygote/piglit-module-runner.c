@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-module-runner.c
+ *
+ * Run many GL tests in one process, from their shared module builds (see
+ * PIGLIT_BUILD_TEST_MODULES).
+ *
+ * Usage: piglit-module-runner <module directory> [<test list>]
+ *
+ * The test list, or stdin, contains one test command line per line, with
+ * the arguments separated by whitespace, e.g. "fbo-blit -auto -fbo". For
+ * each line, the runner prints "piglit-module-runner: <command line>" and
+ * runs the test with a new framework and context, loading
+ * <module directory>/<test name>.so. The test prints its results as usual.
+ *
+ * Tests that call exit() themselves, or crash, end the whole run. The last
+ * command printed is the one to blame, the tests after it can be run by a
+ * new runner.
+ */
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piglit-util-gl.h"
+
+static enum piglit_result
+run_test(const char *module_dir, int argc, char **argv)
+{
+	piglit_gl_test_module_config_func config_func;
+	enum piglit_result result;
+	const char *name;
+	char *module;
+	void *handle;
+
+	name = strrchr(argv[0], '/');
+	name = name ? name + 1 : argv[0];
+
+	if (asprintf(&module, "%s/%s.so", module_dir, name) < 0)
+		return PIGLIT_FAIL;
+
+	/* RTLD_LOCAL, so piglit_init() and friends of one test don't
+	 * resolve to those of another.
+	 */
+	handle = dlopen(module, RTLD_NOW | RTLD_LOCAL);
+	free(module);
+	if (handle == NULL) {
+		printf("piglit-module-runner: %s\n", dlerror());
+		printf("PIGLIT: {\"result\": \"fail\" }\n");
+		return PIGLIT_FAIL;
+	}
+
+	config_func = (piglit_gl_test_module_config_func)
+		dlsym(handle, "piglit_gl_test_module_config");
+	if (config_func == NULL) {
+		printf("piglit-module-runner: %s is not a GL test\n", name);
+		printf("PIGLIT: {\"result\": \"fail\" }\n");
+		dlclose(handle);
+		return PIGLIT_FAIL;
+	}
+
+	result = piglit_gl_test_run_module(config_func, argc, argv);
+
+	/* Unload the test so running it again starts from fresh statics. */
+	dlclose(handle);
+	return result;
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned counts[PIGLIT_WARN + 1] = { 0 };
+	char *line = NULL;
+	size_t line_size = 0;
+	FILE *list;
+
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr,
+			"usage: %s <module directory> [<test list>]\n",
+			argv[0]);
+		return 1;
+	}
+
+	list = argc == 3 ? fopen(argv[2], "r") : stdin;
+	if (list == NULL) {
+		perror(argv[2]);
+		return 1;
+	}
+
+	piglit_general_init();
+
+	while (getline(&line, &line_size, list) >= 0) {
+		char *test_argv[64];
+		char *saveptr = NULL;
+		int test_argc = 0;
+		char *arg;
+
+		line[strcspn(line, "\n")] = '\0';
+		if (line[strspn(line, " \t")] == '\0')
+			continue;
+
+		printf("piglit-module-runner: %s\n", line);
+		fflush(stdout);
+
+		for (arg = strtok_r(line, " \t", &saveptr);
+		     arg && test_argc < (int) ARRAY_SIZE(test_argv) - 1;
+		     arg = strtok_r(NULL, " \t", &saveptr))
+			test_argv[test_argc++] = arg;
+		test_argv[test_argc] = NULL;
+
+		counts[run_test(argv[1], test_argc, test_argv)]++;
+	}
+
+	printf("piglit-module-runner: pass %u, fail %u, skip %u, warn %u\n",
+	       counts[PIGLIT_PASS], counts[PIGLIT_FAIL], counts[PIGLIT_SKIP],
+	       counts[PIGLIT_WARN]);
+
+	free(line);
+	return counts[PIGLIT_FAIL] ? 1 : 0;
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright © 2026 Igalia S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-zygote.c
+ *
+ * A fork server that starts tests without exec.
+ *
+ * The zygote is linked against the piglit util library and everything it
+ * depends on, so the dynamic loader maps and relocates libGL, libEGL, waffle
+ * and friends once, before the first fork. Each test is then run by forking
+ * the zygote, loading the shared module build of the test (see
+ * PIGLIT_BUILD_TEST_MODULES) and calling its main().
+ *
+ * Usage: piglit-zygote <socket path> <module directory>
+ *
+ * The runner connects to the UNIX socket once per test and sends a request:
+ * a 32-bit length in host byte order, followed by that many bytes of
+ * NUL-terminated strings: the working directory, the environment as
+ * KEY=VALUE strings, an empty string, the command line and another empty
+ * string. The request carries the stdout and stderr file descriptors of the
+ * test as SCM_RIGHTS ancillary data.
+ *
+ * The zygote answers with text lines: "pid <pid>" once the test started,
+ * then "exit <code>" or "signal <number>" when it finished. If there is no
+ * module for the command, or it can't be loaded, the only answer is
+ * "error <message>" and the runner starts the test the usual way.
+ *
+ * Additional libraries to load before forking, like the GL driver, can be
+ * listed in PIGLIT_ZYGOTE_PRELOAD, separated by colons.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+/* Upper bound of a request, to not trust the length blindly. */
+#define MAX_REQUEST_SIZE (16 * 1024 * 1024)
+
+static const char *module_dir;
+
+static void
+reply(int conn, const char *format, ...)
+{
+	char buf[512];
+	va_list va;
+	int len;
+
+	va_start(va, format);
+	len = vsnprintf(buf, sizeof(buf), format, va);
+	va_end(va);
+
+	if (len < 0)
+		return;
+	if (len >= (int) sizeof(buf))
+		len = sizeof(buf) - 1;
+
+	/* If the runner went away there is nobody to tell. */
+	if (write(conn, buf, len) != len)
+		_exit(1);
+}
+
+static bool
+read_all(int fd, void *buf, size_t size)
+{
+	char *p = buf;
+
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= n;
+	}
+
+	return true;
+}
+
+/**
+ * Receive the request header and the stdout/stderr descriptors passed with
+ * it.
+ */
+static bool
+receive_header(int conn, uint32_t *length, int fds[2])
+{
+	char control[CMSG_SPACE(2 * sizeof(int))];
+	struct iovec iov = {
+		.iov_base = length,
+		.iov_len = sizeof(*length),
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control,
+		.msg_controllen = sizeof(control),
+	};
+	struct cmsghdr *cmsg;
+	ssize_t n;
+
+	do {
+		n = recvmsg(conn, &msg, MSG_WAITALL);
+	} while (n < 0 && errno == EINTR);
+
+	if (n != sizeof(*length))
+		return false;
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+	    cmsg->cmsg_type != SCM_RIGHTS ||
+	    cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+		return false;
+
+	memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+	return true;
+}
+
+/**
+ * Split the NUL-terminated strings starting at \a *p into a NULL-terminated
+ * array, up to the first empty string.
+ */
+static char **
+split_strings(char **p, const char *end)
+{
+	char **list;
+	char *s;
+	int count = 0;
+	int i;
+
+	for (s = *p; s < end && *s != '\0'; s += strlen(s) + 1)
+		count++;
+	if (s >= end)
+		return NULL;
+
+	list = calloc(count + 1, sizeof(*list));
+	for (i = 0; i < count; i++) {
+		list[i] = *p;
+		*p += strlen(*p) + 1;
+	}
+
+	/* Skip the terminating empty string. */
+	*p += 1;
+	return list;
+}
+
+/**
+ * Run the test of one request. This runs in a child of the zygote, which
+ * waits for the test in a grandchild so it can report how it exited.
+ */
+static void
+handle_connection(int conn)
+{
+	int (*test_main)(int, char **);
+	char module[4096];
+	char *request, *p, *end, *cwd, *name;
+	char **env, **argv;
+	uint32_t length;
+	int fds[2];
+	int argc, status;
+	void *handle;
+	pid_t pid;
+
+	signal(SIGCHLD, SIG_DFL);
+
+	if (!receive_header(conn, &length, fds) || length == 0 ||
+	    length > MAX_REQUEST_SIZE)
+		_exit(1);
+
+	request = malloc(length);
+	if (request == NULL || !read_all(conn, request, length) ||
+	    request[length - 1] != '\0')
+		_exit(1);
+
+	p = request;
+	end = request + length;
+	cwd = p;
+	p += strlen(p) + 1;
+	env = p < end ? split_strings(&p, end) : NULL;
+	argv = env && p < end ? split_strings(&p, end) : NULL;
+	if (argv == NULL || argv[0] == NULL) {
+		reply(conn, "error malformed request\n");
+		_exit(1);
+	}
+	for (argc = 0; argv[argc]; argc++)
+		;
+
+	name = strrchr(argv[0], '/');
+	name = name ? name + 1 : argv[0];
+	snprintf(module, sizeof(module), "%s/%s.so", module_dir, name);
+	if (access(module, R_OK) != 0) {
+		reply(conn, "error no module for %s\n", name);
+		_exit(0);
+	}
+
+	environ = env;
+	if (chdir(cwd) != 0) {
+		reply(conn, "error chdir %s: %s\n", cwd, strerror(errno));
+		_exit(0);
+	}
+
+	handle = dlopen(module, RTLD_NOW);
+	if (handle == NULL) {
+		reply(conn, "error %s\n", dlerror());
+		_exit(0);
+	}
+
+	test_main = (int (*)(int, char **)) dlsym(handle, "main");
+	if (test_main == NULL) {
+		reply(conn, "error no main in %s\n", module);
+		_exit(0);
+	}
+
+	pid = fork();
+	if (pid < 0) {
+		reply(conn, "error fork: %s\n", strerror(errno));
+		_exit(0);
+	}
+
+	if (pid == 0) {
+		int null_fd = open("/dev/null", O_RDONLY);
+
+		/* Like the runner does for tests it starts itself, put the
+		 * test in its own session so a timeout can kill its children.
+		 */
+		setsid();
+
+		dup2(null_fd, STDIN_FILENO);
+		dup2(fds[0], STDOUT_FILENO);
+		dup2(fds[1], STDERR_FILENO);
+		close(null_fd);
+		close(fds[0]);
+		close(fds[1]);
+		close(conn);
+
+		exit(test_main(argc, argv));
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+	reply(conn, "pid %d\n", (int) pid);
+
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR)
+			_exit(1);
+	}
+
+	if (WIFSIGNALED(status))
+		reply(conn, "signal %d\n", WTERMSIG(status));
+	else
+		reply(conn, "exit %d\n", WEXITSTATUS(status));
+
+	_exit(0);
+}
+
+static void
+preload_libraries(void)
+{
+	const char *env = getenv("PIGLIT_ZYGOTE_PRELOAD");
+	char *list, *lib, *saveptr = NULL;
+
+	if (env == NULL)
+		return;
+
+	list = strdup(env);
+	for (lib = strtok_r(list, ":", &saveptr); lib != NULL;
+	     lib = strtok_r(NULL, ":", &saveptr)) {
+		if (dlopen(lib, RTLD_NOW) == NULL)
+			fprintf(stderr, "piglit-zygote: %s\n", dlerror());
+	}
+	free(list);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	int sock;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s <socket path> <module directory>\n",
+			argv[0]);
+		return 1;
+	}
+
+	module_dir = argv[2];
+
+	if (strlen(argv[1]) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "piglit-zygote: socket path too long\n");
+		return 1;
+	}
+	strcpy(addr.sun_path, argv[1]);
+
+	preload_libraries();
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0 ||
+	    bind(sock, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+	    listen(sock, 64) != 0) {
+		perror("piglit-zygote");
+		return 1;
+	}
+
+	/* Let the kernel reap the connection handlers. */
+	signal(SIGCHLD, SIG_IGN);
+
+	for (;;) {
+		int conn = accept(sock, NULL, NULL);
+		pid_t pid;
+
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			perror("piglit-zygote: accept");
+			return 1;
+		}
+
+		pid = fork();
+		if (pid == 0) {
+			close(sock);
+			handle_connection(conn);
+		} else if (pid < 0) {
+			perror("piglit-zygote: fork");
+		}
+
+		close(conn);
+	}
+}
@@ -0,0 +1,106 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+
+"""Benchmark of the compression modes on a results file.
+
+Run from the top of the source tree:
+
+    python3 -m unittests.framework.backends.bench_compression RESULTS
+        [--modes bz2,gz,xz,zstd] [--threads N] [--level N]
+
+RESULTS is a results file or folder in any format piglit can load. The
+results are written as the JSON backend writes them, then compressed and
+decompressed with each mode, and the ratio and the throughput relative to the
+uncompressed JSON are reported. Every mode must read back the same text.
+"""
+
+import argparse
+import os
+import shutil
+import tempfile
+import time
+
+from framework import backends
+from framework.backends import compression
+
+
+def bench(mode, text, directory):
+    filename = os.path.join(directory,
+                            'results.json' + compression.get_suffix(mode))
+
+    start = time.perf_counter()
+    with compression.COMPRESSORS[mode](filename) as f:
+        f.write(text)
+    compress = time.perf_counter() - start
+
+    start = time.perf_counter()
+    with compression.DECOMPRESSORS[mode](filename) as f:
+        actual = f.read()
+    decompress = time.perf_counter() - start
+
+    assert actual == text, '{} did not read back the results'.format(mode)
+    return os.path.getsize(filename), compress, decompress
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('results')
+    parser.add_argument('--modes', default='bz2,gz,xz,zstd',
+                        type=lambda s: s.split(','))
+    parser.add_argument('--threads', type=int, default=None)
+    parser.add_argument('--level', type=int, default=None)
+    args = parser.parse_args()
+
+    if args.threads is not None:
+        os.environ['PIGLIT_COMPRESSION_THREADS'] = str(args.threads)
+    if args.level is not None:
+        os.environ['PIGLIT_COMPRESSION_LEVEL'] = str(args.level)
+
+    directory = tempfile.mkdtemp()
+    try:
+        # Write the results uncompressed, the same way the backend does
+        filename = os.path.join(directory, 'results.json')
+        os.environ['PIGLIT_COMPRESSION'] = 'none'
+        backends.json.write_results(backends.load(args.results), filename)
+        with open(filename, 'r', encoding='utf-8') as f:
+            text = f.read()
+        size = len(text.encode('utf-8'))
+        mib = size / (1024 * 1024)
+        print('{:>5}: {:10d} bytes, {} threads'.format(
+            'json', size, compression.get_threads()))
+
+        for mode in args.modes:
+            if mode not in compression.COMPRESSORS:
+                print('{:>5}: not supported'.format(mode))
+                continue
+            csize, compress, decompress = bench(mode, text, directory)
+            print('{:>5}: {:10d} bytes, ratio {:6.2f}, compress {:8.1f} MiB/s, '
+                  'decompress {:8.1f} MiB/s'.format(
+                      mode, csize, size / csize, mib / compress,
+                      mib / decompress))
+    finally:
+        shutil.rmtree(directory)
+
+
+if __name__ == '__main__':
+    main()
@@ -22,6 +22,7 @@
 """Tests for compression in file backends."""
 
 import itertools
+import json
 import os
 import subprocess
 try:
@@ -31,10 +32,13 @@ except ImportError:
 
 import pytest
 
+from framework import backends
 from framework import core
+from framework import exceptions
 from framework.backends import abstract
 from framework.backends import compression
 
+from . import shared
 from .. import skip
 
 # pylint: disable=no-self-use,redefined-outer-name
@@ -115,10 +119,17 @@ def compressor():
         yield c
 
 
+def _zstd(*values):
+    """A parameter that needs the zstandard module."""
+    return pytest.param(*values, marks=pytest.mark.skipif(
+        'zstd' not in compression.COMPRESSORS,
+        reason="Requires the zstandard module."))
+
+
 # Tests
 
 
-@pytest.mark.parametrize("mode", ['none', 'bz2', 'gz', 'xz'])
+@pytest.mark.parametrize("mode", ['none', 'bz2', 'gz', 'xz', _zstd('zstd')])
 def test_compress(mode, tmpdir):
     """Test that each compressor that we want works.
 
@@ -132,7 +143,7 @@ def test_compress(mode, tmpdir):
         f.write('foo')
 
 
-@pytest.mark.parametrize("mode", ['none', 'bz2', 'gz', 'xz'])
+@pytest.mark.parametrize("mode", ['none', 'bz2', 'gz', 'xz', _zstd('zstd')])
 def test_decompress(mode, tmpdir):
     """Test that each supported decompressor works.
 
@@ -151,6 +162,35 @@ def test_decompress(mode, tmpdir):
     assert actual == 'foo'
 
 
+@pytest.mark.parametrize("threads", [1, 3])
+@pytest.mark.parametrize("mode", ['bz2', 'gz', 'xz', _zstd('zstd')])
+def test_blocks(mode, threads, tmpdir, env, mocker):
+    """Files of several blocks decompress to the original text."""
+    mocker.patch('framework.backends.compression.BLOCK_SIZE', 100)
+    env['PIGLIT_COMPRESSION_THREADS'] = str(threads)
+    expected = ''.join('line {} ü\n'.format(i) for i in range(1000))
+    testfile = tmpdir.join('test')
+
+    with compression.COMPRESSORS[mode](str(testfile)) as f:
+        f.write(expected)
+
+    with compression.DECOMPRESSORS[mode](str(testfile)) as f:
+        actual = f.read()
+
+    assert actual == expected
+
+
+@pytest.mark.parametrize("mode", ['bz2', 'gz', 'xz', _zstd('zstd')])
+def test_empty(mode, tmpdir):
+    """An empty file is a valid compressed file."""
+    testfile = tmpdir.join('test')
+    with compression.COMPRESSORS[mode](str(testfile)):
+        pass
+
+    with compression.DECOMPRESSORS[mode](str(testfile)) as f:
+        assert f.read() == ''
+
+
 @skip.posix
 class TestXZBin(object):
     """Tests for the xz bin path on python2.x."""
@@ -212,14 +252,85 @@ class TestGetMode(object):
         assert compression.get_mode() == 'foobar'
 
 
-@pytest.mark.parametrize("extension", ['bz2', 'gz', 'xz'])
+@pytest.mark.parametrize("mode,level", [
+    ('bz2', '1'), ('gz', '0'), ('xz', '9'), _zstd('zstd', '19')])
+def test_level(mode, level, tmpdir, env):
+    """Files compressed with a level decompress to the original text."""
+    env['PIGLIT_COMPRESSION_LEVEL'] = level
+    testfile = tmpdir.join('test')
+
+    with compression.COMPRESSORS[mode](str(testfile)) as f:
+        f.write('foo')
+
+    with compression.DECOMPRESSORS[mode](str(testfile)) as f:
+        assert f.read() == 'foo'
+
+
+class TestGetLevel(object):
+    """Tests for the compression.get_level function."""
+
+    def test_default(self, env, config):  # pylint: disable=unused-argument
+        env.clear()
+
+        assert compression.get_level('bz2') is None
+
+    def test_env(self, env, config):
+        config.set('core', 'compression_level', '2')
+        env['PIGLIT_COMPRESSION_LEVEL'] = '3'
+
+        assert compression.get_level('gz') == 3
+
+    def test_piglit_conf(self, env, config):
+        config.set('core', 'compression_level', '2')
+        env.clear()
+
+        assert compression.get_level('gz') == 2
+
+    @pytest.mark.parametrize("level", ['0', '23', 'fast'])
+    def test_invalid(self, level, env, config):  # pylint: disable=unused-argument
+        env['PIGLIT_COMPRESSION_LEVEL'] = level
+
+        with pytest.raises(exceptions.PiglitFatalError):
+            compression.get_level('zstd' if level != '0' else 'bz2')
+
+
+class TestGetThreads(object):
+    """Tests for the compression.get_threads function."""
+
+    def test_default(self, env, config, mocker):  # pylint: disable=unused-argument
+        env.clear()
+        mocker.patch('framework.backends.compression.os.cpu_count',
+                     mocker.Mock(return_value=6))
+
+        assert compression.get_threads() == 6
+
+    def test_env(self, env, config):
+        config.set('core', 'compression_threads', '2')
+        env['PIGLIT_COMPRESSION_THREADS'] = '3'
+
+        assert compression.get_threads() == 3
+
+    def test_piglit_conf(self, env, config):
+        config.set('core', 'compression_threads', '2')
+        env.clear()
+
+        assert compression.get_threads() == 2
+
+    def test_invalid(self, env, config):  # pylint: disable=unused-argument
+        env['PIGLIT_COMPRESSION_THREADS'] = 'many'
+
+        with pytest.raises(exceptions.PiglitFatalError):
+            compression.get_threads()
+
+
+@pytest.mark.parametrize("extension", ['bz2', 'gz', 'xz', _zstd('zstd')])
 def test_duplicate_extensions(extension, tmpdir, config):
     """Tests that exersizes a bug that caused the compressed extension to be
     duplicated in some cases.
     """
     tmpdir.chdir()
     config.set('core', 'compression', extension)
-    expected = 'results.txt.' + extension
+    expected = 'results.txt' + compression.get_suffix(extension)
 
     with abstract.write_compressed(expected) as f:
         f.write('foo')
@@ -242,3 +353,34 @@ def test_changed_extension(orig, new, tmpdir, config):
     assert 'results.txt.' + new in os.listdir('.')
     assert 'results.txt.' + orig not in os.listdir('.')
     assert 'results.txt.{}.{}'.format(orig, new) not in os.listdir('.')
+
+
+@pytest.mark.parametrize("mode", ['bz2', 'gz', 'xz', _zstd('zstd')])
+def test_load(mode, tmpdir, env, config):
+    """The compression of a results file is detected when it is loaded."""
+    env.clear()
+    config.set('core', 'compression', mode)
+
+    with abstract.write_compressed(str(tmpdir.join('results.json'))) as f:
+        f.write(json.dumps(shared.JSON))
+
+    assert tmpdir.join('results.json' + compression.get_suffix(mode)).check()
+    assert backends.load(str(tmpdir)).name == shared.JSON['name']
+
+
+def test_zst_suffix():
+    """zstd results use the suffix of the zstd tools."""
+    assert compression.get_suffix('zstd') == '.zst'
+    assert compression.get_mode_of_suffix('.zst') == 'zstd'
+
+
+def test_load_unsupported(tmpdir, compressor):
+    """Loading results of a mode that isn't installed says what's missing.
+    """
+    if 'zstd' in compression.COMPRESSORS:
+        compressor.rm('zstd')
+    tmpdir.join('results.json.zst').write('')
+
+    with pytest.raises(compression.UnsupportedCompressor) as e:
+        backends.load(str(tmpdir))
+    assert 'zstandard' in str(e.value)
@@ -0,0 +1,131 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+
+"""Tests for the results journal."""
+
+import os
+
+import pytest
+
+from framework.backends import journal
+
+# pylint: disable=no-self-use,protected-access
+
+
+def _write(path, records):
+    writer = journal.Writer(str(path))
+    for kind, name, data in records:
+        writer.append(kind, name, data)
+    writer.close()
+
+
+class TestJournal(object):
+    """Tests for the Writer and Reader classes."""
+
+    def test_round_trip(self, tmpdir):
+        p = tmpdir.join('results.journal')
+        records = [(journal.STARTED, 'a', '{}'),
+                   (journal.FINISHED, 'a', '{"result": "pass"}'),
+                   (journal.STARTED, 'spec@ü', '{}')]
+        _write(p, records)
+
+        assert list(journal.Reader(str(p))) == records
+
+    def test_latest_wins(self, tmpdir):
+        """The latest record of a test wins, in first written order."""
+        p = tmpdir.join('results.journal')
+        _write(p, [(journal.STARTED, 'a', '1'),
+                   (journal.STARTED, 'b', '2'),
+                   (journal.FINISHED, 'a', '3')])
+
+        assert list(journal.Reader(str(p)).tests()) == [('a', '3'), ('b', '2')]
+
+    def test_torn_tail(self, tmpdir):
+        """A truncated record ends the journal."""
+        p = tmpdir.join('results.journal')
+        _write(p, [(journal.STARTED, 'a', '1'), (journal.STARTED, 'b', '2')])
+        with p.open('r+b') as f:
+            f.truncate(os.path.getsize(str(p)) - 1)
+
+        assert list(journal.Reader(str(p)).tests()) == [('a', '1')]
+
+    def test_checksum(self, tmpdir):
+        """A corrupted record ends the journal."""
+        p = tmpdir.join('results.journal')
+        _write(p, [(journal.STARTED, 'a', '1'), (journal.STARTED, 'b', '2'),
+                   (journal.STARTED, 'c', '3')])
+        data = bytearray(p.read_binary())
+        data[data.index(b'b\n2') + 2] = ord('x')
+        p.write_binary(bytes(data))
+
+        assert list(journal.Reader(str(p)).tests()) == [('a', '1')]
+
+    def test_repairs_torn_tail(self, tmpdir):
+        """Records appended after a torn record can be read."""
+        p = tmpdir.join('results.journal')
+        _write(p, [(journal.STARTED, 'a', '1')])
+        with p.open('ab') as f:
+            f.write(b'\x00\x00\x00\x10torn')
+        _write(p, [(journal.STARTED, 'b', '2')])
+
+        assert list(journal.Reader(str(p)).tests()) == [('a', '1'), ('b', '2')]
+
+    def test_fork(self, tmpdir):
+        """Forked processes append to the same journal."""
+        p = tmpdir.join('results.journal')
+        writer = journal.Writer(str(p))
+        writer.open()
+
+        pids = []
+        for i in range(4):
+            pid = os.fork()
+            if pid == 0:
+                for j in range(50):
+                    writer.append(journal.FINISHED, '{}/{}'.format(i, j),
+                                  'x' * 1000)
+                os._exit(0)
+            pids.append(pid)
+        for pid in pids:
+            os.waitpid(pid, 0)
+        writer.close()
+
+        assert len(journal.Reader(str(p)).latest()) == 200
+
+    def test_short_write(self, tmpdir, mocker):
+        """A short write raises, and so does every later append."""
+        p = tmpdir.join('results.journal')
+        writer = journal.Writer(str(p))
+        writer.append(journal.STARTED, 'a', '1')
+
+        write = os.write
+        mocker.patch('framework.backends.journal.os.write',
+                     lambda fd, data: write(fd, data[:5]))
+        with pytest.raises(OSError):
+            writer.append(journal.STARTED, 'b', '2')
+        mocker.stopall()
+
+        with pytest.raises(OSError):
+            writer.append(journal.STARTED, 'c', '3')
+        writer.close()
+
+        assert list(journal.Reader(str(p)).tests()) == [('a', '1')]
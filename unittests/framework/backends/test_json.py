@@ -81,7 +81,8 @@ class TestJSONBackend(object):
             with test.write_test('bar') as t:
                 t(results.TestResult())
 
-            assert tmpdir.join('tests/0.json').check()
+            assert tmpdir.join('results.journal').check()
+            assert not tmpdir.join('tests').check()
 
         def test_load(self, tmpdir):
             """Test that the written JSON can be loaded.
@@ -97,8 +98,32 @@ class TestJSONBackend(object):
             with test.write_test('bar') as t:
                 t(results.TestResult())
 
-            with tmpdir.join('tests/0.json').open('r') as f:
-                json.load(f)
+            reader = backends.journal.Reader(
+                str(tmpdir.join('results.journal')))
+            for _, _, data in reader:
+                json.loads(data)
+
+        def test_share_with_processes(self, tmpdir):
+            """Forked processes append to the same journal."""
+            p = str(tmpdir)
+            test = backends.json.JSONBackend(p)
+            test.initialize(shared.INITIAL_METADATA)
+
+            with test.write_test('a') as t:
+                t(results.TestResult())
+            test.share_with_processes()
+
+            pid = os.fork()
+            if pid == 0:
+                with test.write_test('b') as t:
+                    t(results.TestResult())
+                os._exit(0)
+            os.waitpid(pid, 0)
+            with test.write_test('c') as t:
+                t(results.TestResult())
+
+            assert list(backends.json._iter_tests(p)) == [
+                ('a', mock.ANY), ('b', mock.ANY), ('c', mock.ANY)]
 
     class TestFinalize(object):
         """Tests for the finalize method."""
@@ -122,8 +147,8 @@ class TestJSONBackend(object):
         def test_metadata_removed(self, result_dir):
             assert not result_dir.join('metadata.json').check()
 
-        def test_tests_directory_removed(self, result_dir):
-            assert not result_dir.join('tests').check()
+        def test_journal_removed(self, result_dir):
+            assert not result_dir.join('results.journal').check()
 
         def test_results_file_created(self, result_dir):
             # Normally this would also have a compression extension, but this
@@ -151,11 +176,51 @@ class TestJSONBackend(object):
             test.initialize(shared.INITIAL_METADATA)
             with test.write_test(self.name) as t:
                 t(self.result)
-            tmpdir.join('tests/2.json.tmp').write('{}')
+            with tmpdir.join('results.journal').open('ab') as f:
+                f.write(b'\x00\x00\x00\x10torn')
             test.finalize(
                 {'time_elapsed':
                     results.TimeAttribute(start=0.0, end=1.0).to_json()})
 
+        @staticmethod
+        def _run(directory, tests):
+            test = backends.json.JSONBackend(str(directory))
+            test.initialize(shared.INITIAL_METADATA)
+            for name, result in tests:
+                with test.write_test(name) as t:
+                    t(result)
+            test.finalize(
+                {'time_elapsed':
+                    results.TimeAttribute(start=0.0, end=1.0).to_json()})
+            with directory.join('results.json').open('r') as f:
+                return json.load(f)
+
+        def test_totals(self, tmpdir):
+            """The totals are counted while the tests are streamed."""
+            subtests = results.TestResult('fail')
+            subtests.subtests['x'] = 'pass'
+            subtests.subtests['y'] = 'skip'
+            json_ = self._run(tmpdir, [('a@b', results.TestResult('pass')),
+                                       ('a@c', subtests)])
+
+            expected = results.TestrunResult.from_dict(
+                {'tests': json_['tests']}).totals
+            assert json_['totals'] == json.loads(json.dumps(expected))
+            assert json_['totals']['root']['pass'] == 2
+
+        def test_parallel(self, tmpdir, mocker):
+            """Tests encoded by a pool of processes are written in order."""
+            mocker.patch('framework.backends.json._PARALLEL_TESTS', 1)
+            mocker.patch('framework.backends.json._CHUNK_SIZE', 3)
+            mocker.patch('framework.backends.json.os.cpu_count',
+                         mocker.Mock(return_value=2))
+            names = ['group{}/test{}'.format(i % 3, i) for i in range(50)]
+            json_ = self._run(tmpdir, [(n, results.TestResult('pass'))
+                                       for n in names])
+
+            assert list(json_['tests']) == names
+            assert json_['totals']['root']['pass'] == 50
+
 
 class TestUpdateResults(object):
     """Test for the _update_results function."""
@@ -202,10 +267,10 @@ class TestResume(object):
         assert set(test.tests.keys()) == \
             {'group1/test1', 'group1/test2', 'group2/test3'}
 
-    def test_load_invalid_ext(self, tmpdir):
-        """backends.json._resume: ignores invalid results extensions.
+    def test_load_torn_record(self, tmpdir):
+        """backends.json._resume: ignores a torn record.
 
-        This gets triggered by an incomplete atomic write
+        This gets triggered by a crash while a record is appended
         """
         f = str(tmpdir)
         backend = backends.json.JSONBackend(f)
@@ -216,8 +281,8 @@ class TestResume(object):
             t(results.TestResult('pass'))
         with backend.write_test("group2/test3") as t:
             t(results.TestResult('fail'))
-        with open(os.path.join(f, 'tests', '3.json.tmp'), 'w') as w:
-            w.write('foo')
+        with open(os.path.join(f, 'results.journal'), 'ab') as w:
+            w.write(b'\x00\x00\x00\x10torn')
         test = backends.json._resume(f)
 
         assert set(test.tests.keys()) == \
@@ -248,6 +313,39 @@ class TestResume(object):
         assert set(test.tests.keys()) == \
             {'group1/test1', 'group1/test2', 'group2/test3', 'group2/test4'}
 
+    def test_load_rerun(self, tmpdir):
+        """backends.json._resume: the latest result of a test wins."""
+        f = str(tmpdir)
+        backend = backends.json.JSONBackend(f)
+        backend.initialize(shared.INITIAL_METADATA)
+        with backend.write_test("group1/test1") as t:
+            t(results.TestResult('incomplete'))
+        with backend.write_test("group1/test2") as t:
+            t(results.TestResult('pass'))
+        with backend.write_test("group1/test1") as t:
+            t(results.TestResult('fail'))
+        test = backends.json._resume(f)
+
+        assert list(test.tests.keys()) == ['group1/test1', 'group1/test2']
+        assert test.tests['group1/test1'].result == 'fail'
+
+    def test_load_tests_folder(self, tmpdir):
+        """backends.json._resume: loads the tests folder of runs started
+        without a journal.
+        """
+        f = str(tmpdir)
+        backend = backends.json.JSONBackend(f)
+        backend.initialize(shared.INITIAL_METADATA)
+        tmpdir.mkdir('tests')
+        tmpdir.join('tests', '0.json').write(
+            json.dumps({'group1/test1': results.TestResult('pass')},
+                       default=backends.json.piglit_encoder))
+        with backend.write_test("group1/test2") as t:
+            t(results.TestResult('fail'))
+        test = backends.json._resume(f)
+
+        assert list(test.tests.keys()) == ['group1/test1', 'group1/test2']
+
 
 class TestLoadResults(object):
     """Tests for the load_results function."""
@@ -268,6 +366,19 @@ class TestLoadResults(object):
             f.write(json.dumps(shared.JSON))
         backends.json.load_results(str(p), 'none')
 
+    def test_load_journal(self, tmpdir):
+        """backends.json.load_results: Loads a run in progress from its
+        journal.
+        """
+        backend = backends.json.JSONBackend(str(tmpdir))
+        backend.initialize(shared.INITIAL_METADATA)
+        with backend.write_test('a test') as t:
+            t(results.TestResult('pass'))
+
+        test = backends.json.load_results(
+            str(tmpdir.join('results.journal')), 'none')
+        assert list(test.tests.keys()) == ['a test']
+
     def test_inst(self, tmpdir):
         p = tmpdir.join('my file')
         with p.open('w') as f:
@@ -57,6 +57,7 @@ class TestGetBackend(object):
     @pytest.mark.parametrize("name,expected", [
         ('json', backends.json.JSONBackend),
         ('junit', backends.junit.JUnitBackend),
+        ('sqlite', backends.sqlite.SQLiteBackend),
     ])
     def test_basic(self, name, expected):
         """Test that ensures the expected input and output."""
@@ -0,0 +1,190 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Tests for the sqlite backend."""
+
+import contextlib
+import json
+import os
+import sqlite3
+
+import jsonschema
+import pytest
+
+from framework import backends
+from framework import exceptions
+from framework import grouptools
+from framework import results
+
+from . import shared
+
+# pylint: disable=no-self-use,protected-access
+
+SCHEMA = os.path.join(os.path.dirname(__file__), 'schema',
+                      'piglit-{}.json'.format(backends.json.CURRENT_JSON_VERSION))
+
+
+def _query(directory, statement):
+    with contextlib.closing(sqlite3.connect(
+            str(directory.join('results.db')))) as conn:
+        return conn.execute(statement).fetchall()
+
+
+class TestSQLiteBackend(object):
+    """Tests for the SQLiteBackend class."""
+
+    def test_incomplete_committed(self, tmpdir, mocker):
+        """With --sync a started test is visible to other connections."""
+        mocker.patch('framework.backends.sqlite.options.OPTIONS.sync', True)
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        test.initialize(shared.INITIAL_METADATA)
+        with test.write_test('a') as t:
+            assert _query(tmpdir, 'SELECT name, result FROM tests') == \
+                [('a', 'incomplete')]
+            t(results.TestResult('pass'))
+
+    def test_batched(self, tmpdir, mocker):
+        """Without --sync tests are committed in batches."""
+        mocker.patch('framework.backends.sqlite.options.OPTIONS.sync', False)
+        mocker.patch('framework.backends.sqlite._BATCH_SIZE', 4)
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        test.initialize(shared.INITIAL_METADATA)
+        with test.write_test('a') as t:
+            assert _query(tmpdir, 'SELECT name FROM tests') == []
+            t(results.TestResult('pass'))
+        with test.write_test('b') as t:
+            t(results.TestResult('pass'))
+
+        assert _query(tmpdir, 'SELECT name FROM tests') == [('a', ), ('b', )]
+
+    def test_resume(self, tmpdir):
+        """A resumed run replaces incomplete tests in place."""
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        test.initialize(shared.INITIAL_METADATA)
+        with test.write_test('a') as t:
+            t(results.TestResult('pass'))
+        with test.write_test('b'):
+            pass
+        with test.write_test('c') as t:
+            t(results.TestResult('pass'))
+        # Piglit stops without finalizing, after the last batch was committed.
+        test._conn.commit()
+        test._conn.close()
+
+        loaded = backends.load(str(tmpdir))
+        assert loaded.tests['b'].result == 'incomplete'
+
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        with test.write_test('b') as t:
+            t(results.TestResult('fail'))
+        test.finalize()
+
+        loaded = backends.load(str(tmpdir))
+        assert list(loaded.tests) == ['a', 'b', 'c']
+        assert loaded.tests['b'].result == 'fail'
+
+    def test_share_with_processes(self, tmpdir):
+        """Forked processes write into the same database."""
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        test.initialize(shared.INITIAL_METADATA)
+        with test.write_test('a') as t:
+            t(results.TestResult('pass'))
+        test.share_with_processes()
+
+        pid = os.fork()
+        if pid == 0:
+            with test.write_test('b') as t:
+                t(results.TestResult('pass'))
+            os._exit(0)
+        os.waitpid(pid, 0)
+        with test.write_test('c') as t:
+            t(results.TestResult('pass'))
+        test.finalize()
+
+        assert _query(tmpdir, 'SELECT name, result FROM tests ORDER BY id') \
+            == [('a', 'pass'), ('b', 'pass'), ('c', 'pass')]
+
+    def test_no_tests(self, tmpdir):
+        """finalize raises if no test was run."""
+        test = backends.sqlite.SQLiteBackend(str(tmpdir))
+        test.initialize(shared.INITIAL_METADATA)
+        with pytest.raises(exceptions.PiglitUserError):
+            test.finalize()
+
+    class TestFinalize(object):
+        """Tests for the finalize method."""
+
+        name = grouptools.join('a', 'test', 'group', 'test1')
+
+        @pytest.fixture(scope='class')
+        def result_dir(self, tmpdir_factory):
+            directory = tmpdir_factory.mktemp('main')
+            test = backends.sqlite.SQLiteBackend(str(directory))
+            test.initialize(shared.INITIAL_METADATA)
+            with test.write_test(self.name) as t:
+                t(results.TestResult('pass'))
+            with test.write_test('b') as t:
+                t(results.TestResult('fail'))
+            test.finalize(
+                {'time_elapsed':
+                    results.TimeAttribute(start=0.0, end=1.0).to_json()})
+            return directory
+
+        def test_single_file(self, result_dir):
+            """The write-ahead log is merged into the database."""
+            assert sorted(os.listdir(str(result_dir))) == ['results.db']
+
+        def test_status_index(self, result_dir):
+            """Tests can be queried by status."""
+            assert _query(result_dir,
+                          "SELECT name FROM tests WHERE result = 'fail'") == \
+                [('b',)]
+
+        def test_load(self, result_dir):
+            """The results load through the backends package."""
+            loaded = backends.load(str(result_dir))
+            assert loaded.name == 'name'
+            assert loaded.tests[self.name].result == 'pass'
+            assert loaded.time_elapsed.end == 1.0
+
+        def test_results_are_valid(self, result_dir):
+            """The loaded results match the JSON schema."""
+            loaded = backends.load(str(result_dir))
+            json_ = json.loads(json.dumps(
+                loaded, default=backends.json.piglit_encoder))
+
+            with open(SCHEMA, 'r') as f:
+                schema = json.load(f)
+
+            jsonschema.validate(json_, schema)
+
+
+def test_write_results(tmpdir):
+    """backends.sqlite.write_results: writes a TestrunResult that loads
+    again.
+    """
+    result = results.TestrunResult.from_dict(shared.JSON)
+    p = str(tmpdir.join('results.db'))
+    assert backends.write(result, p)
+    loaded = backends.load(p)
+    assert list(loaded.tests) == list(result.tests)
+    assert loaded.tests[next(iter(result.tests))].result == 'fail'
@@ -0,0 +1,120 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Microbenchmark of profile.RegexFilter against searching each regex.
+
+Run from the top of the source tree:
+
+    python3 -m unittests.framework.bench_profile [--tests N] [--filters N]
+
+The filters are modeled after CI skip lists: mostly exact test names, some
+group prefixes and a few real regular expressions. Both implementations must
+select the same tests.
+"""
+
+import argparse
+import random
+import re
+import time
+
+from framework import profile
+
+
+class LinearRegexFilter(object):
+    """The RegexFilter implementation that searches every regex in turn."""
+
+    def __init__(self, filters, inverse=False):
+        self.filters = [re.compile(f, flags=re.IGNORECASE) for f in filters]
+        self.inverse = inverse
+
+    def __call__(self, name, _):
+        if not self.filters:
+            return True
+
+        if not self.inverse:
+            return any(r.search(name) for r in self.filters)
+        else:
+            return not any(r.search(name) for r in self.filters)
+
+
+def make_names(count, rand):
+    words = ['arb_texture', 'execution', 'compiler', 'fs', 'vs', 'gs',
+             'linker', 'sampler', 'uniform', 'clip', 'float', 'double',
+             'ivec4', 'mat3', 'array', 'struct', 'api', 'query']
+    names = set()
+    while len(names) < count:
+        names.add('spec@' + '@'.join(
+            '-'.join(rand.choice(words) for _ in range(rand.randint(1, 3)))
+            for _ in range(rand.randint(2, 4))))
+    return sorted(names)
+
+
+def make_filters(names, count, rand):
+    filters = []
+    for _ in range(count):
+        name = rand.choice(names)
+        kind = rand.random()
+        if kind < 0.8:
+            filters.append('^' + re.escape(name) + '$')
+        elif kind < 0.95:
+            filters.append('^' + re.escape(name.rsplit('@', 1)[0]) + '@')
+        else:
+            filters.append(re.escape(name.split('@')[1]) + '.*' +
+                           name.rsplit('-', 1)[-1])
+    return filters
+
+
+def bench(cls, filters, names):
+    start = time.perf_counter()
+    filter_ = cls(filters, inverse=True)
+    setup = time.perf_counter() - start
+
+    start = time.perf_counter()
+    selected = [n for n in names if filter_(n, None)]
+    run = time.perf_counter() - start
+    return setup, run, selected
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--tests', type=int, default=60000)
+    parser.add_argument('--filters', type=int, default=5000)
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    rand = random.Random(args.seed)
+    names = make_names(args.tests, rand)
+    filters = make_filters(names, args.filters, rand)
+
+    results = {}
+    for label, cls in [('linear', LinearRegexFilter),
+                       ('combined', profile.RegexFilter)]:
+        setup, run, selected = bench(cls, filters, names)
+        results[label] = selected
+        print('{:>8}: setup {:8.3f} s, filter {:8.3f} s, {} of {} tests '
+              'selected'.format(label, setup, run, len(selected), len(names)))
+
+    assert results['linear'] == results['combined'], 'selections differ'
+
+
+if __name__ == '__main__':
+    main()
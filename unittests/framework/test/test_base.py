@@ -189,6 +189,25 @@ class TestTest(object):
             test.run()
             assert test.result.result is status.TIMEOUT
 
+        @pytest.mark.timeout(6)
+        def test_timeout_output(self):
+            """test.base.Test: A timed out test keeps its output."""
+            test = _Test(['sh', '-c', 'echo started; echo warm >&2; sleep 60'])
+            test.timeout = 1
+            test.run()
+            assert test.result.result is status.TIMEOUT
+            assert 'started' in test.result.out
+            assert test.result.err == 'warm\n'
+
+        @pytest.mark.timeout(6)
+        def test_timeout_no_grace(self, mocker):
+            """test.base.Test: A test exiting on SIGTERM is not waited for."""
+            mocker.patch('framework.test.base._KILL_GRACE', 60)
+            test = _Test(['sleep', '60'])
+            test.timeout = 1
+            test.run()
+            assert test.result.result is status.TIMEOUT
+
     class TestExecuteTraceback(object):
         """Test.execute tests for Traceback handling."""
 
@@ -0,0 +1,169 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Tests for framework.executor."""
+
+import threading
+
+from framework import executor
+
+
+class TestTokenQueue(object):
+    """Tests for the TokenQueue class."""
+
+    def test_fifo(self):
+        """executor.TokenQueue: items without tokens come out in order"""
+        q = executor.TokenQueue()
+        for i in range(3):
+            q.push(i)
+        assert [q.pop()[0] for _ in range(3)] == [0, 1, 2]
+        assert q.pop() is None
+
+    def test_shared(self):
+        """executor.TokenQueue: shared tokens can be held many times"""
+        q = executor.TokenQueue()
+        q.push('a', shared={'gpu'})
+        q.push('b', shared={'gpu'})
+        assert q.pop()[0] == 'a'
+        assert q.pop()[0] == 'b'
+
+    def test_exclusive_waits(self):
+        """executor.TokenQueue: exclusive tokens wait for the holders"""
+        q = executor.TokenQueue()
+        q.push('a', shared={'gpu'})
+        q.push('b', exclusive={'gpu'})
+        a = q.pop()
+        assert q.pop() is None
+        q.release(*a[1:])
+        assert q.pop()[0] == 'b'
+
+    def test_no_overtaking(self):
+        """executor.TokenQueue: later items don't take a waiting item's tokens
+        """
+        q = executor.TokenQueue()
+        q.push('a', shared={'gpu'})
+        q.push('b', exclusive={'gpu'})
+        q.push('c', shared={'gpu'})
+        q.push('d', shared={'cpu'})
+        assert q.pop()[0] == 'a'
+        assert q.pop()[0] == 'd'
+        assert q.pop() is None
+
+    def test_exclusive_only(self):
+        """executor.TokenQueue: exclusive_only skips items without exclusive
+        tokens
+        """
+        q = executor.TokenQueue()
+        q.push('a', shared={'gpu'})
+        q.push('b', exclusive={'display'})
+        assert q.pop(exclusive_only=True)[0] == 'b'
+        assert q.pop(exclusive_only=True) is None
+        assert q.pop()[0] == 'a'
+
+    def test_len(self):
+        """executor.TokenQueue: len counts the queued items"""
+        q = executor.TokenQueue()
+        q.push('a', exclusive={'display'})
+        q.push('b', exclusive={'display'})
+        q.pop()
+        assert len(q) == 1
+
+
+class TestExecutor(object):
+    """Tests for the Executor class."""
+
+    def test_runs_all(self):
+        """executor.Executor: every job runs"""
+        done = []
+        lock = threading.Lock()
+
+        def job(i):
+            with lock:
+                done.append(i)
+
+        pool = executor.Executor(4)
+        for i in range(100):
+            pool.apply_async(job, [i], shared={'gpu'} if i % 2 else set(),
+                             exclusive={'display'} if i % 7 == 0 else set())
+        pool.close()
+        pool.join()
+        assert sorted(done) == list(range(100))
+
+    def test_exclusive(self):
+        """executor.Executor: exclusive jobs never overlap"""
+        running = []
+        overlap = []
+        lock = threading.Lock()
+
+        def job():
+            with lock:
+                if running:
+                    overlap.append(True)
+                running.append(True)
+            threading.Event().wait(0.001)
+            with lock:
+                running.pop()
+
+        pool = executor.Executor(4)
+        for _ in range(20):
+            pool.apply_async(job, exclusive={'display'})
+        pool.close()
+        pool.join()
+        assert not overlap
+
+    def test_exclusive_jobs(self):
+        """executor.Executor: exclusive jobs get their own thread"""
+        release = threading.Event()
+        done = threading.Event()
+
+        pool = executor.Executor(1, 1)
+        pool.apply_async(release.wait, [5])
+        pool.apply_async(done.set, exclusive={'display'})
+        # The first job blocks the only general thread.
+        assert done.wait(5)
+        release.set()
+        pool.close()
+        pool.join()
+
+    def test_failing_job(self):
+        """executor.Executor: a failing job doesn't stop the others"""
+        done = []
+
+        def fail():
+            raise ValueError
+
+        pool = executor.Executor(1)
+        pool.apply_async(fail)
+        pool.apply_async(done.append, [1])
+        pool.close()
+        pool.join()
+        assert done == [1]
+
+    def test_terminate(self):
+        """executor.Executor: terminate drops the queued jobs"""
+        done = []
+        pool = executor.Executor(1)
+        pool.apply_async(pool.terminate)
+        for i in range(10):
+            pool.apply_async(done.append, [i])
+        pool.join()
+        assert done == []
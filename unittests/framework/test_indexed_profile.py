@@ -0,0 +1,124 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Tests for framework.indexed_profile."""
+
+import json
+import os
+
+import pytest
+
+from framework import exceptions
+from framework import indexed_profile
+
+# pylint: disable=invalid-name,no-self-use,protected-access
+
+
+def _records(count):
+    return [{'name': 'group@test {:05d}'.format(i), 'type': 'gl',
+             'options': {'command': repr(['test', str(i)])}}
+            for i in reversed(range(count))]
+
+
+@pytest.fixture
+def big(tmpdir, monkeypatch):
+    """A profile with many record and index blocks."""
+    monkeypatch.setattr(indexed_profile, '_BLOCK_SIZE', 1024)
+    p = str(tmpdir.join('big.profile'))
+    indexed_profile.write(p, 'big', _records(1000))
+    return p
+
+
+class TestReader(object):
+    """Tests for indexed_profile.Reader."""
+
+    def test_header(self, big):
+        """Reads the name and the number of tests."""
+        with indexed_profile.Reader(big) as r:
+            assert r.name == 'big'
+            assert len(r) == 1000
+
+    def test_iter(self, big):
+        """Iterates the records in the order they were written."""
+        with indexed_profile.Reader(big) as r:
+            assert list(r) == _records(1000)
+
+    def test_get(self, big):
+        """Finds every test by name."""
+        with indexed_profile.Reader(big) as r:
+            for record in _records(1000):
+                assert r.get(record['name']) == record
+
+    def test_get_missing(self, big):
+        """Returns None for tests that don't exist."""
+        with indexed_profile.Reader(big) as r:
+            assert r.get('group@test 00500x') is None
+            assert r.get('a') is None
+            assert r.get('zzz') is None
+            assert 'zzz' not in r
+            assert 'group@test 00500' in r
+
+    def test_get_while_iterating(self, big):
+        """Lookups don't disturb an iteration."""
+        with indexed_profile.Reader(big) as r:
+            names = []
+            for record in r:
+                names.append(record['name'])
+                r.get('group@test 00000')
+            assert len(names) == 1000
+
+    def test_compressed(self, tmpdir):
+        """The records are stored compressed."""
+        p = str(tmpdir.join('c.profile'))
+        indexed_profile.write(p, 'c', _records(1000))
+        raw = sum(len(json.dumps(r)) for r in _records(1000))
+        assert os.path.getsize(p) < raw // 4
+
+    def test_unicode(self, tmpdir):
+        """Finds names that are not ASCII."""
+        p = str(tmpdir.join('u.profile'))
+        records = [{'name': n, 'type': 'gl', 'options': {}}
+                   for n in ['b', 'é', 'a', 'z']]
+        indexed_profile.write(p, 'u', records)
+        with indexed_profile.Reader(p) as r:
+            assert r.get('é') == records[1]
+
+    def test_empty(self, tmpdir):
+        """A profile without tests."""
+        p = str(tmpdir.join('e.profile'))
+        indexed_profile.write(p, 'e', [])
+        with indexed_profile.Reader(p) as r:
+            assert len(r) == 0
+            assert list(r) == []
+            assert r.get('a') is None
+
+    def test_not_a_profile(self, tmpdir):
+        """Raises PiglitFatalError for other files."""
+        p = tmpdir.join('bad.profile')
+        p.write('<PiglitTestList/>\n')
+        with pytest.raises(exceptions.PiglitFatalError):
+            indexed_profile.Reader(str(p))
+
+    def test_missing(self, tmpdir):
+        """Raises PiglitFatalError for missing files."""
+        with pytest.raises(exceptions.PiglitFatalError):
+            indexed_profile.Reader(str(tmpdir.join('missing.profile')))
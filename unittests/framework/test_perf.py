@@ -0,0 +1,110 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.perf."""
+
+import pytest
+
+from framework import perf, results, status
+
+
+def _m(rate, stddev=0.0):
+    return {'rate': rate, 'stddev': stddev}
+
+
+class TestCompare(object):
+    """Tests for the compare function."""
+
+    @pytest.mark.parametrize("rate, expected", [
+        (100.0, status.PASS),
+        (110.0, status.PASS),
+        (96.0, status.PASS),
+        (94.0, status.WARN),
+        (89.0, status.FAIL),
+    ])
+    def test_status(self, rate, expected):
+        """perf.compare: the drop is checked against the tolerances"""
+        c = perf.compare('a', _m(100.0), _m(rate), 0.05, 0.10)
+        assert c.status == expected
+
+    def test_noise(self):
+        """perf.compare: a drop within the noise is not a regression"""
+        c = perf.compare('a', _m(100.0, 10.0), _m(85.0, 10.0), 0.05, 0.10)
+        assert c.status == status.PASS
+
+    def test_ratio(self):
+        """perf.compare: the ratio is current over baseline"""
+        c = perf.compare('a', _m(100.0), _m(150.0), 0.05, 0.10)
+        assert c.ratio == pytest.approx(1.5)
+
+    @pytest.mark.parametrize("base, current, expected", [
+        (_m(100.0, 1.0), _m(101.0, 1.0), True),
+        (_m(100.0, 1.0), _m(110.0, 1.0), False),
+    ])
+    def test_overlap(self, base, current, expected):
+        """perf.compare: confidence interval overlap"""
+        assert perf.compare('a', base, current, 0.05, 0.10).overlap is expected
+
+    def test_zero_baseline(self):
+        """perf.compare: a zero baseline is never a regression"""
+        c = perf.compare('a', _m(0.0), _m(10.0), 0.05, 0.10)
+        assert c.status == status.PASS
+
+
+class TestBaseline(object):
+    """Tests for the Baseline class."""
+
+    @pytest.fixture
+    def baseline(self):
+        run = results.TestrunResult()
+        run.tests['perf@fill-rate'] = results.TestResult('pass')
+        run.tests['perf@fill-rate'].perf = {'a': _m(100.0), 'b': _m(100.0)}
+        return perf.Baseline(run, 0.05, 0.10)
+
+    def test_compare_missing(self, baseline):
+        """perf.Baseline.compare: measurements without baseline are ignored"""
+        result = results.TestResult('pass')
+        result.perf = {'a': _m(100.0), 'c': _m(1.0)}
+        assert [c.name for c in baseline.compare('perf@fill-rate', result)] \
+            == ['a']
+
+    def test_apply_fail(self, baseline):
+        """perf.Baseline.apply: the worst regression sets the status"""
+        result = results.TestResult('pass')
+        result.perf = {'a': _m(94.0), 'b': _m(50.0)}
+        baseline.apply('perf@fill-rate', result)
+        assert result.result == status.FAIL
+        assert 'perf: b:' in result.out
+
+    def test_apply_keeps_failure(self, baseline):
+        """perf.Baseline.apply: a failed test is not turned into a warn"""
+        result = results.TestResult('crash')
+        result.perf = {'a': _m(94.0)}
+        baseline.apply('perf@fill-rate', result)
+        assert result.result == status.CRASH
+
+    def test_apply_pass(self, baseline):
+        """perf.Baseline.apply: no regression leaves the result alone"""
+        result = results.TestResult('pass')
+        result.perf = {'a': _m(99.0)}
+        baseline.apply('perf@fill-rate', result)
+        assert result.result == status.PASS
+        assert result.out == ''
@@ -0,0 +1,111 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Tests for framework.process_executor."""
+
+import os
+
+from framework import process_executor
+
+
+class _LogManager(object):
+    """A LogManager that records what its logs were told."""
+    def __init__(self):
+        self.started = []
+        self.logged = []
+
+    def get(self):
+        manager = self
+
+        class Log(object):
+            def start(self, name):
+                manager.started.append(name)
+
+            def log(self, status):
+                manager.logged.append(status)
+
+        return Log()
+
+
+def _run_test(directory):
+    def run_test(name, test, profile, log):
+        log.start(name)
+        with open(os.path.join(directory, name), 'w') as f:
+            f.write(str(os.getpid()))
+        log.log('pass')
+        return test
+    return run_test
+
+
+def test_runs_all(tmpdir):
+    """process_executor.ProcessExecutor: every test runs once, elsewhere"""
+    tests = [('t{}'.format(i), None, None) for i in range(20)]
+    manager = _LogManager()
+    workers = process_executor.ProcessExecutor(
+        tests, _run_test(str(tmpdir)), manager, 3, 2)
+    assert workers.join() is None
+
+    assert sorted(os.listdir(str(tmpdir))) == sorted(n for n, _, _ in tests)
+    assert str(os.getpid()) not in {f.read() for f in tmpdir.listdir()}
+
+
+def test_log_forwarded(tmpdir):
+    """process_executor.ProcessExecutor: the log is kept in this process"""
+    tests = [('t{}'.format(i), None, None) for i in range(5)]
+    manager = _LogManager()
+    workers = process_executor.ProcessExecutor(
+        tests, _run_test(str(tmpdir)), manager, 2, 1)
+    workers.join()
+
+    assert sorted(manager.started) == sorted(n for n, _, _ in tests)
+    assert manager.logged == ['pass'] * 5
+
+
+def test_abort(tmpdir):
+    """process_executor.ProcessExecutor: a test can abort the run"""
+    tests = [('t{}'.format(i), 'stop' if i == 0 else None, None)
+             for i in range(50)]
+    workers = process_executor.ProcessExecutor(
+        tests, _run_test(str(tmpdir)), _LogManager(), 1, 1)
+
+    assert workers.join() == 'stop'
+    assert len(tmpdir.listdir()) == 1
+
+
+def test_raises(tmpdir):
+    """process_executor.ProcessExecutor: a test that raises is logged"""
+    def run_test(name, test, profile, log):
+        if name == 't1':
+            log.start(name)
+            raise RuntimeError('backend failed')
+        if name == 't2':
+            raise RuntimeError('backend failed')
+        log.start(name)
+        log.log('pass')
+
+    tests = [('t{}'.format(i), None, None) for i in range(4)]
+    manager = _LogManager()
+    workers = process_executor.ProcessExecutor(tests, run_test, manager, 1, 1)
+    assert workers.join() is None
+
+    assert sorted(manager.started) == ['t0', 't1', 't2', 't3']
+    assert sorted(manager.logged) == ['crash', 'crash', 'pass', 'pass']
@@ -21,10 +21,13 @@
 
 """ Provides test for the framework.profile modules """
 
+import re
+
 import pytest
 
 from framework import exceptions
 from framework import grouptools
+from framework import indexed_profile
 from framework import profile
 from . import utils
 
@@ -58,6 +61,81 @@ class TestLoadTestProfile(object):
             profile.load_test_profile('this_module_will_never_ever_exist')
 
 
+class TestIndexedProfile(object):
+    """Tests for profile.IndexedProfile."""
+
+    @pytest.fixture
+    def filename(self, tmpdir):
+        p = str(tmpdir.join('test.profile'))
+        indexed_profile.write(p, 'test', [
+            {'name': 'a@b', 'type': 'gl',
+             'options': {'command': repr(['b']),
+                         'run_concurrent': repr(True),
+                         'require_platforms': repr(['glx'])},
+             'env': {'FOO': 'bar'}},
+            {'name': 'a@multi', 'type': 'multi_shader',
+             'options': {'prog': repr('shader_runner'),
+                         'files': repr(['x.shader_test', 'y.shader_test']),
+                         'subtests': repr(['x', 'y'])},
+             'skips': [{'api_version': repr(3.0)}, {}]},
+            {'name': 'c', 'type': 'gl',
+             'options': {'command': repr(['c'])}},
+        ])
+        return p
+
+    def test_load(self, filename):
+        """profile.load_test_profile: loads indexed profiles."""
+        assert isinstance(profile.load_test_profile(filename),
+                          profile.IndexedProfile)
+
+    def test_len(self, filename):
+        """profile.IndexedProfile: len is the number of tests."""
+        assert len(profile.IndexedProfile(filename)) == 3
+
+    def test_itertests(self, filename):
+        """profile.IndexedProfile.itertests: rebuilds the tests."""
+        tests = dict(profile.IndexedProfile(filename).itertests())
+        assert list(tests) == ['a@b', 'a@multi', 'c']
+        assert tests['a@b'].command[0].endswith('b')
+        assert tests['a@b'].env == {'FOO': 'bar'}
+        assert tests['a@b'].require_platforms == ['glx']
+        assert len(tests['a@multi'].skips) == 2
+        assert tests['a@multi'].skips[0].api_version == 3.0
+
+    def test_forced_test_list(self, filename):
+        """profile.IndexedProfile.itertests: runs the forced test list in
+        order.
+        """
+        p = profile.IndexedProfile(filename)
+        p.forced_test_list = ['c', 'a@b']
+        assert [n for n, _ in p.itertests()] == ['c', 'a@b']
+        assert len(p) == 2
+
+    def test_forced_test_list_missing(self, filename):
+        """profile.IndexedProfile.itertests: fails for missing tests."""
+        p = profile.IndexedProfile(filename)
+        p.forced_test_list = ['c', 'd']
+        with pytest.raises(exceptions.PiglitFatalError):
+            list(p.itertests())
+
+    def test_forced_test_list_ignore_missing(self, filename):
+        """profile.IndexedProfile.itertests: adds missing tests as notrun if
+        ignore_missing is set.
+        """
+        p = profile.IndexedProfile(filename)
+        p.options['ignore_missing'] = True
+        p.forced_test_list = ['c', 'd']
+        tests = dict(p.itertests())
+        assert tests['d'].result.result == 'notrun'
+
+    def test_filters(self, filename):
+        """profile.IndexedProfile.itertests: applies the filters."""
+        p = profile.IndexedProfile(filename)
+        p.filters.append(profile.RegexFilter([r'^a@']))
+        assert [n for n, _ in p.itertests()] == ['a@b', 'a@multi']
+        assert len(p) == 2
+
+
 class TestTestProfile(object):
     """Tests for profile.TestProfile."""
 
@@ -267,6 +345,56 @@ class TestRegexFilter(object):
             test = profile.RegexFilter([r'fob', r'bar'])
             assert not test('foobob', None)
 
+    class TestCombined(object):
+        """Tests that combining the filters keeps the meaning of each one."""
+
+        names = ['spec@arb_foo@bar', 'spec@arb_foo@bar-baz', 'Spec@ARB_Foo',
+                 'spec@arb_foobar@a.b', 'spec@a$b', 'glean@foo', 'spec@aab',
+                 'spec@ab', 'spec@b', 'spec@x(y)', 'spec@foo@foo', '',
+                 'spec@élève']
+
+        @pytest.mark.parametrize('filters', [
+            [r'^spec@arb_foo@bar$'],
+            [r'^spec@arb_foo@bar'],
+            [r'^SPEC@arb_foo$', r'glean'],
+            [r'arb_foo'],
+            [r'arb_foo', r'arb_foobar@a\.b$'],
+            [r'a.b'],
+            [r'a\.b'],
+            [r'a\$b'],
+            [r'^spec@a*b$'],
+            [r'spec@a+b'],
+            [r'spec@a{2}b'],
+            [r'spec@ab?'],
+            [r'^spec@(a|b)'],
+            [r'foo|glean'],
+            [r'^spec@b|bar$'],
+            [r'x\(y\)'],
+            [r'(foo)@\1'],
+            [r'(?P<n>foo)@(?P=n)', r'glean'],
+            [r'(?i)BAR'],
+            [r'\d', r'@b$'],
+            [r'^'],
+            [r''],
+            [r'$'],
+            [r'^spec@ÉlÈve$'],
+            [r'ÉL'],
+            [r'^spec@arb_foo@bar$', r'^spec@arb_foo', r'^spec@arb_fo'],
+        ], ids=str)
+        @pytest.mark.parametrize('inverse', [False, True])
+        def test_same_as_each_regex(self, filters, inverse):
+            """Selects the tests that searching for each regex does."""
+            regexes = [re.compile(f, flags=re.IGNORECASE) for f in filters]
+            test = profile.RegexFilter(filters, inverse=inverse)
+            for name in self.names:
+                expected = any(r.search(name) for r in regexes) != inverse
+                assert test(name, None) == expected, name
+
+        def test_invalid(self):
+            """Raises for filters that are only valid when grouped."""
+            with pytest.raises(re.error):
+                profile.RegexFilter([r'a)|(b'])
+
     class TestInverse(object):
         """Tests for inverse set to True."""
 
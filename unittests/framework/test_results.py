@@ -111,6 +111,8 @@ class TestTestResult(object):
                     'exception': 'an exception',
                     'dmesg': 'this is dmesg',
                     'pid': [1934],
+                    'perf': {'a': {'rate': 100.0, 'stddev': 1.0}},
+                    'rusage': {'maxrss_kb': 4096, 'utime': 0.5},
                 }
 
                 cls.test = results.TestResult.from_dict(cls.dict)
@@ -167,6 +169,14 @@ class TestTestResult(object):
                 """sets pid properly."""
                 assert self.test.pid == self.dict['pid']
 
+            def test_perf(self):
+                """sets perf properly."""
+                assert self.test.perf == self.dict['perf']
+
+            def test_rusage(self):
+                """sets rusage properly."""
+                assert self.test.rusage == self.dict['rusage']
+
         class TestResult(object):
             """Tests for TestResult.result getter and setter methods."""
 
@@ -227,6 +237,8 @@ class TestTestResult(object):
             test.exception = 'an exception'
             test.dmesg = 'this is dmesg'
             test.pid = 1934
+            test.perf = {'a': {'rate': 100.0, 'stddev': 1.0}}
+            test.rusage = {'maxrss_kb': 4096, 'utime': 0.5}
             test.traceback = 'a traceback'
 
             cls.test = test
@@ -280,6 +292,14 @@ class TestTestResult(object):
             """results.TestResult.to_json: Adds the traceback attribute"""
             assert self.test.traceback == self.json['traceback']
 
+        def test_perf(self):
+            """results.TestResult.to_json: Adds the perf attribute"""
+            assert self.test.perf == self.json['perf']
+
+        def test_rusage(self):
+            """results.TestResult.to_json: Adds the rusage attribute"""
+            assert self.test.rusage == self.json['rusage']
+
     class TestUpdate(object):
         """Tests for TestResult.update."""
 
@@ -295,6 +315,20 @@ class TestTestResult(object):
             test.update({'subtest': {'result': 'incomplete'}})
             assert test.subtests['result'] == 'incomplete'
 
+        def test_perf(self):
+            """results.TestResult.update: perf measurements are merged"""
+            test = results.TestResult('pass')
+            test.update({'perf': {'a': {'rate': 1.0, 'stddev': 0.0}}})
+            test.update({'perf': {'b': {'rate': 2.0, 'stddev': 0.0}}})
+            assert set(test.perf) == {'a', 'b'}
+
+        def test_rusage(self):
+            """results.TestResult.update: the last resource usage wins"""
+            test = results.TestResult('pass')
+            test.update({'rusage': {'maxrss_kb': 1024, 'utime': 0.1}})
+            test.update({'rusage': {'maxrss_kb': 2048, 'utime': 0.2}})
+            assert test.rusage == {'maxrss_kb': 2048, 'utime': 0.2}
+
     class TestTotals(object):
         """Test the totals generated by TestrunResult.calculate_group_totals().
         """
@@ -0,0 +1,113 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Tests for framework.schedule."""
+
+import pytest
+
+from framework import executor, results, schedule
+
+
+class _Test(object):
+    def __init__(self, run_concurrent=True):
+        self.run_concurrent = run_concurrent
+        self.resources = frozenset([executor.GPU])
+        self.exclusive_resources = (
+            frozenset() if run_concurrent else frozenset([executor.DISPLAY]))
+
+
+@pytest.mark.parametrize("durations, workers, expected", [
+    ([], 4, 0.0),
+    ([3.0, 2.0, 1.0], 1, 6.0),
+    ([3.0, 2.0, 1.0], 2, 3.0),
+    ([1.0, 1.0, 4.0], 2, 5.0),
+    ([4.0, 1.0, 1.0], 2, 4.0),
+    ([1.0, 2.0], 8, 2.0),
+])
+def test_makespan(durations, workers, expected):
+    """schedule.makespan: jobs start on the first idle worker"""
+    assert schedule.makespan(durations, workers) == expected
+
+
+def test_token_makespan_exclusive():
+    """schedule.token_makespan: an exclusive job waits for sharing jobs"""
+    jobs = [(2.0, {'gpu'}, set()), (1.0, set(), {'gpu'}),
+            (1.0, {'gpu'}, set()), (1.0, set(), set())]
+    # The exclusive job waits for the first one, the third waits for it
+    # instead of overtaking it, the last one needs nothing.
+    assert schedule.token_makespan(jobs, 4) == 4.0
+
+
+def test_token_makespan_exclusive_workers():
+    """schedule.token_makespan: exclusive workers only run exclusive jobs"""
+    jobs = [(2.0, {'gpu'}, set()), (2.0, {'gpu'}, set()),
+            (1.0, {'gpu'}, {'display'})]
+    # The second job waits for the only general worker, the exclusive one
+    # runs next to the first one.
+    assert schedule.token_makespan(jobs, 1, 1) == 4.0
+    assert schedule.token_makespan(jobs, 1) == 5.0
+
+
+class TestSchedule(object):
+    """Tests for the Schedule class."""
+
+    @pytest.fixture
+    def sched(self):
+        return schedule.Schedule({'a': 1.0, 'b': 5.0, 'c': 3.0})
+
+    def test_estimate_unknown(self, sched):
+        """schedule.Schedule.estimate: unknown tests take the median"""
+        assert sched.estimate('d') == 3.0
+
+    def test_estimate_empty(self):
+        """schedule.Schedule.estimate: no durations at all"""
+        assert schedule.Schedule({}).estimate('a') == 0.0
+
+    def test_order(self, sched):
+        """schedule.Schedule.order: longest first, stable for ties"""
+        tests = [('a', 0), ('d', 1), ('b', 2), ('c', 3)]
+        assert [t[0] for t in sched.order(tests)] == ['b', 'd', 'c', 'a']
+
+    @pytest.mark.parametrize("concurrency, expected", [
+        ('all', 5.0),
+        ('none', 9.0),
+        # 'a' runs serially next to the pool running 'b' and 'c'
+        ('some', 5.0),
+    ])
+    def test_predict(self, sched, concurrency, expected):
+        """schedule.Schedule.predict: serial tests run next to the pool"""
+        tests = [('b', _Test()), ('c', _Test()), ('a', _Test(False))]
+        assert sched.predict(tests, concurrency, 2) == expected
+
+    def test_predict_serial_bound(self, sched):
+        """schedule.Schedule.predict: a long serial chain is the makespan"""
+        tests = [('b', _Test(False)), ('c', _Test(False)), ('a', _Test())]
+        assert sched.predict(tests, 'some', 2) == 8.0
+
+    def test_from_results(self):
+        """schedule.Schedule.from_results: uses the test times"""
+        run = results.TestrunResult()
+        run.tests['a'] = results.TestResult('pass')
+        run.tests['a'].time = results.TimeAttribute(10.0, 12.5)
+        run.tests['b'] = results.TestResult('notrun')
+        sched = schedule.Schedule.from_results(run)
+        assert sched.durations == {'a': 2.5}
@@ -21,6 +21,7 @@
 
 """Test the wflinfo module."""
 
+import json
 import subprocess
 import textwrap
 try:
@@ -354,3 +355,107 @@ class TestWflInfo(object):
             gracefully.
             """
             assert inst.core.shader_version == 0.0
+
+
+class TestSnapshot(object):
+    """Tests for the capability snapshot of WflInfo."""
+
+    OUTPUT = textwrap.dedent("""\
+        Waffle platform: glx
+        Waffle api: gl
+        OpenGL vendor string: Intel
+        OpenGL renderer string: Mesa Intel(R) Xe Graphics
+        OpenGL version string: {} (Core Profile) Mesa 24.0.0
+        OpenGL context flags: 0x0
+        OpenGL shading language version string: 4.60
+        OpenGL extensions: GL_foo GL_bar
+    """)
+
+    @pytest.fixture(autouse=True)
+    def patch(self):
+        with mock.patch.dict('framework.wflinfo.OPTIONS.env',
+                             {'PIGLIT_PLATFORM': 'glx'}):
+            yield
+
+    @staticmethod
+    def _run(check_output, path=None):
+        """Create a fresh WflInfo using check_output to run wflinfo."""
+        with mock.patch('framework.wflinfo.WflInfo._WflInfo__shared_state',
+                        {}), \
+                mock.patch('framework.wflinfo.subprocess.check_output',
+                           check_output):
+            info = wflinfo.WflInfo()
+            if path is not None:
+                info.load_snapshot(path)
+            yield info
+            info.write_snapshot()
+
+    def _check_output(self, version='4.6'):
+        return mock.Mock(
+            return_value=self.OUTPUT.format(version).encode('utf-8'))
+
+    def test_one_call_per_profile(self):
+        """wflinfo.WflInfo: wflinfo is called once per profile."""
+        check_output = self._check_output()
+        for info in self._run(check_output):
+            assert info.core.api_version == 4.6
+            assert info.core.shader_version == 4.6
+            assert info.core.extensions == {'GL_foo', 'GL_bar'}
+        assert check_output.call_count == 1
+
+    def test_reuse(self, tmpdir):
+        """wflinfo.WflInfo: a snapshot of the same driver is reused."""
+        path = str(tmpdir.join('capabilities.json'))
+        for info in self._run(self._check_output(), path):
+            info.compat
+            info.core
+
+        check_output = self._check_output()
+        for info in self._run(check_output, path):
+            assert info.compat.api_version == 4.6
+            assert info.core.api_version == 4.6
+        assert check_output.call_count == 1
+
+    def test_driver_changed(self, tmpdir):
+        """wflinfo.WflInfo: a snapshot of another driver is replaced."""
+        path = str(tmpdir.join('capabilities.json'))
+        for info in self._run(self._check_output('4.5'), path):
+            info.compat
+            info.core
+
+        check_output = self._check_output('4.6')
+        for info in self._run(check_output, path):
+            assert info.compat.api_version == 4.6
+            assert info.core.api_version == 4.6
+        assert check_output.call_count == 2
+
+        with open(path) as f:
+            assert json.load(f)['driver'] == '4.6 (Core Profile) Mesa 24.0.0'
+
+    def test_platform_changed(self, tmpdir):
+        """wflinfo.WflInfo: a snapshot of another platform is ignored."""
+        path = str(tmpdir.join('capabilities.json'))
+        for info in self._run(self._check_output(), path):
+            info.core
+
+        check_output = self._check_output()
+        with mock.patch.dict('framework.wflinfo.OPTIONS.env',
+                             {'PIGLIT_PLATFORM': 'gbm'}):
+            for info in self._run(check_output, path):
+                info.core
+        assert check_output.call_count == 1
+
+    def test_failed_call(self, tmpdir):
+        """wflinfo.WflInfo: profiles wflinfo fails on are cached too."""
+        path = str(tmpdir.join('capabilities.json'))
+        outputs = [self.OUTPUT.format('4.6').encode('utf-8'),
+                   subprocess.CalledProcessError(1, 'wflinfo')]
+        for info in self._run(mock.Mock(side_effect=outputs), path):
+            info.compat
+            assert info.es1.api_version == 0.0
+
+        check_output = self._check_output()
+        for info in self._run(check_output, path):
+            info.compat
+            assert info.es1.api_version == 0.0
+        assert check_output.call_count == 1
@@ -0,0 +1,129 @@
+# encoding=utf-8
+# Copyright © 2026 Igalia S.L.
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.zygote."""
+
+import os
+import signal
+import subprocess
+import sys
+import textwrap
+
+import pytest
+
+from framework import zygote
+
+# A stand-in for piglit-zygote speaking the same protocol. The test name
+# selects the behavior, the arguments are echoed to stdout.
+_FAKE_ZYGOTE = textwrap.dedent("""\
+    #!{python}
+    import os, signal, socket, struct, subprocess, sys, threading
+
+    def handle(conn):
+        msg, fds, _, _ = socket.recv_fds(conn, 4, 2)
+        length, = struct.unpack('=I', msg)
+        data = b''
+        while len(data) < length:
+            data += conn.recv(length - len(data))
+        strings = data.split(b'\\0')
+        argv = strings[strings.index(b'', 1) + 1:-2]
+        name = os.path.basename(argv[0]).decode()
+
+        if name == 'missing':
+            conn.sendall(b'error no module for missing\\n')
+            return
+
+        if name == 'hang':
+            proc = subprocess.Popen(['sleep', '60'], stdout=fds[0],
+                                    stderr=fds[1])
+        else:
+            proc = subprocess.Popen(
+                ['sh', '-c', 'echo "$@"; echo err >&2; exit 3', 'sh'] +
+                [a.decode() for a in argv[1:]],
+                stdout=fds[0], stderr=fds[1], cwd=strings[0])
+        os.close(fds[0])
+        os.close(fds[1])
+        conn.sendall('pid {{}}\\n'.format(proc.pid).encode())
+        code = proc.wait()
+        if code < 0:
+            conn.sendall('signal {{}}\\n'.format(-code).encode())
+        else:
+            conn.sendall('exit {{}}\\n'.format(code).encode())
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.bind(sys.argv[1])
+    sock.listen(8)
+    while True:
+        threading.Thread(target=handle, args=(sock.accept()[0],),
+                         daemon=True).start()
+    """)
+
+
+@pytest.fixture
+def server(tmpdir):
+    path = tmpdir.join('piglit-zygote')
+    path.write(_FAKE_ZYGOTE.format(python=sys.executable))
+    path.chmod(0o755)
+
+    zygote.start(str(tmpdir))
+    yield str(tmpdir)
+    zygote.stop()
+
+
+@pytest.mark.skipif(sys.version_info < (3, 9), reason='needs socket.recv_fds')
+class TestSpawn(object):
+    """Tests for zygote.spawn."""
+
+    def test_not_started(self, tmpdir):
+        """zygote.spawn: returns None if no server is running"""
+        assert zygote.spawn([str(tmpdir.join('test'))], None, {}) is None
+
+    def test_other_dir(self, server):
+        """zygote.spawn: returns None for commands outside bin_dir"""
+        assert zygote.spawn(['/bin/true'], None, {}) is None
+
+    def test_error(self, server):
+        """zygote.spawn: returns None if the zygote refuses the test"""
+        assert zygote.spawn([os.path.join(server, 'missing')], None,
+                            {}) is None
+
+    def test_output(self, server):
+        """zygote.spawn: communicate returns stdout and stderr"""
+        proc = zygote.spawn([os.path.join(server, 'test'), 'a', 'b'], None,
+                            {})
+        assert proc.communicate(timeout=10) == ('a b\n', 'err\n')
+
+    def test_returncode(self, server):
+        """zygote.spawn: returncode is the exit code of the test"""
+        proc = zygote.spawn([os.path.join(server, 'test')], None, {})
+        proc.communicate(timeout=10)
+        assert proc.returncode == 3
+
+    def test_timeout(self, server):
+        """zygote.spawn: communicate raises TimeoutExpired"""
+        proc = zygote.spawn([os.path.join(server, 'hang')], None, {})
+        with pytest.raises(subprocess.TimeoutExpired):
+            proc.communicate(timeout=0.1)
+        assert proc.poll() is None
+
+        proc.terminate()
+        proc.communicate(timeout=10)
+        assert proc.returncode == -signal.SIGTERM